@@ -3,34 +3,27 @@ package cpuid
 
 func cpuid(eax, ecx uint32) (eaxr, ebxr, ecxr, edxr uint32)
 
-// cpuidoffline simulates the cpuid instruction using the data from the JSON file.
+// cpuidoffline simulates the cpuid instruction using the data from the JSON or binary dump file.
+// The file is loaded once and indexed, see LoadSnapshot.
 func cpuidoffline(eax, ecx uint32, filename string) (a, b, c, d uint32) {
-	data, err := DataFromFile(filename)
+	f, err := loadOffline(filename)
 	if err != nil {
-		// If unable to load the data, return zeros.
+		// If unable to load the data, return zeros. CPUIDWithModeErr reports the error.
 		return 0, 0, 0, 0
 	}
 
-	// Search for a matching leaf and subleaf.
-	for _, entry := range data.Entries {
-		if entry.Leaf == eax && entry.Subleaf == ecx {
-			return entry.EAX, entry.EBX, entry.ECX, entry.EDX
-		}
-	}
-	// If not found, return zeros.
-	return 0, 0, 0, 0
+	// If not found, Lookup returns zeros.
+	statOfflineLookup()
+	a, b, c, d, _ = f.src.Lookup(eax, ecx)
+	return a, b, c, d
 }
 
 // CPUIDWithMode returns the result of the cpuid instruction for the given eax and ecx values.
+// Live results come from the process-wide snapshot, see LiveSnapshot and Refresh.
 func CPUIDWithMode(eax, ecx uint32, offline bool, filename string) (a, b, c, d uint32) {
 	if !offline {
-		// Call the live assembly implementation.
-		return cpuid(eax, ecx)
-	}
-
-	// Use default filename if none provided.
-	if filename == "" {
-		filename = "cpuid_data.json"
+		// Serve from the snapshot, the assembly implementation only runs on a miss.
+		return currentLive().cpuid(eax, ecx)
 	}
 
 	return cpuidoffline(eax, ecx, filename)
@@ -74,7 +67,3 @@ func GetIntelHybrid(offline bool, filename string) IntelHybridInfo {
 
 	return hybridInfo
 }
-
-func int32ToBytes(i uint32) []byte {
-	return []byte{byte(i), byte(i >> 8), byte(i >> 16), byte(i >> 24)}
-}
@@ -0,0 +1,91 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+// AMXPalette describes one tile palette from CPUID leaf 0x1D. Palette 1 is the one
+// configured by LDTILECFG on all current implementations.
+type AMXPalette struct {
+	ID             uint32
+	TotalTileBytes uint32 // EAX[15:0], bytes of tile storage
+	BytesPerTile   uint32 // EAX[31:16]
+	BytesPerRow    uint32 // EBX[15:0], the maximum colsb of a tile
+	MaxNames       uint32 // EBX[31:16], number of tile registers
+	MaxRows        uint32 // ECX[15:0]
+}
+
+// AMXInfo describes the AMX tile architecture (leaf 0x1D) and the tile matrix multiply unit
+// (leaf 0x1E).
+type AMXInfo struct {
+	Supported  bool   // CPUID.(EAX=07H,ECX=0):EDX.AMX-TILE[bit 24]
+	MaxPalette uint32 // highest palette ID, from 0x1D.0 EAX
+	Palettes   []AMXPalette
+
+	TMULMaxK uint32 // 0x1E.0 EBX[7:0], maximum rows (K) of a TMUL source tile
+	TMULMaxN uint32 // 0x1E.0 EBX[23:8], maximum column bytes (N) of a TMUL result tile
+
+	Features []string // supported TMULFeatures (leaf 0x1E subleaf 1), e.g. AMX_FP8
+}
+
+// Palette returns the palette with the given ID, or false if the CPU does not report it.
+func (a AMXInfo) Palette(id uint32) (AMXPalette, bool) {
+	for _, p := range a.Palettes {
+		if p.ID == id {
+			return p, true
+		}
+	}
+	return AMXPalette{}, false
+}
+
+// amxSupported reports CPUID.(EAX=07H,ECX=0):EDX.AMX-TILE.
+func amxSupported(offline bool, filename string) bool {
+	if maxStd, _, _, _ := CPUIDWithMode(0, 0, offline, filename); maxStd < 7 {
+		return false
+	}
+	_, _, _, d := CPUIDWithMode(7, 0, offline, filename)
+	return d&(1<<24) != 0
+}
+
+// hasTMULFeatureLeaf reports whether leaf 0x1E has the feature subleaf 1.
+func hasTMULFeatureLeaf(offline bool, filename string) bool {
+	if maxStd, _, _, _ := CPUIDWithMode(0, 0, offline, filename); maxStd < 0x1E || !amxSupported(offline, filename) {
+		return false
+	}
+	a, _, _, _ := CPUIDWithMode(0x1E, 0, offline, filename)
+	return a >= 1
+}
+
+// GetAMXInfo decodes the AMX palette and TMUL leaves. Offline dumps answer from the captured
+// subleaves, so tile configurations can be computed for a host type without running on it.
+// It reports what the CPU implements; check IsFeatureUsable("AMX_TILE", ...) before executing
+// tile instructions.
+func GetAMXInfo(offline bool, filename string) AMXInfo {
+	var info AMXInfo
+	maxStd, _, _, _ := CPUIDWithMode(0, 0, offline, filename)
+	if maxStd < 0x1D || !amxSupported(offline, filename) {
+		return info
+	}
+	info.Supported = true
+
+	forEachSubleaf(0x1D, modeGetter(offline, filename), func(id, a, b, c, _ uint32) bool {
+		if id == 0 {
+			info.MaxPalette = a
+			return true
+		}
+		info.Palettes = append(info.Palettes, AMXPalette{
+			ID:             id,
+			TotalTileBytes: a & 0xFFFF,
+			BytesPerTile:   a >> 16,
+			BytesPerRow:    b & 0xFFFF,
+			MaxNames:       b >> 16,
+			MaxRows:        c & 0xFFFF,
+		})
+		return true
+	})
+
+	if maxStd >= 0x1E {
+		_, b, _, _ := CPUIDWithMode(0x1E, 0, offline, filename)
+		info.TMULMaxK = b & 0xFF
+		info.TMULMaxN = (b >> 8) & 0xFFFF
+		info.Features = GetSupportedFeatures("TMULFeatures", offline, filename)
+	}
+	return info
+}
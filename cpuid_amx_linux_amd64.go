@@ -0,0 +1,38 @@
+//go:build linux && amd64
+// +build linux,amd64
+
+package cpuid
+
+import (
+	"sync"
+	"syscall"
+	"unsafe"
+)
+
+const (
+	archGetXCompPerm = 0x1022 // ARCH_GET_XCOMP_PERM
+	archReqXCompPerm = 0x1023 // ARCH_REQ_XCOMP_PERM
+	xfeatureTileData = 18     // XFEATURE_XTILEDATA
+)
+
+var (
+	amxPermOnce sync.Once
+	amxPermErr  error
+)
+
+// RequestAMXPermission asks the kernel (5.16 and later) to let this process use the AMX tile
+// data state with arch_prctl(ARCH_REQ_XCOMP_PERM). Without it AMX instructions fault even when
+// XCR0 enables them. The permission is process-wide; the request is made once and its result
+// is cached.
+func RequestAMXPermission() error {
+	amxPermOnce.Do(func() {
+		var perm uint64
+		if _, _, errno := syscall.RawSyscall(syscall.SYS_ARCH_PRCTL, archGetXCompPerm, uintptr(unsafe.Pointer(&perm)), 0); errno == 0 && perm&XStateTileData != 0 {
+			return
+		}
+		if _, _, errno := syscall.RawSyscall(syscall.SYS_ARCH_PRCTL, archReqXCompPerm, xfeatureTileData, 0); errno != 0 {
+			amxPermErr = errno
+		}
+	})
+	return amxPermErr
+}
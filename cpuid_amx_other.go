@@ -0,0 +1,10 @@
+//go:build !linux || !amd64
+// +build !linux !amd64
+
+package cpuid
+
+// RequestAMXPermission is a no-op outside Linux on amd64: other systems grant the AMX state to
+// every process once XCR0 enables it, and AMX is not available to 32-bit code.
+func RequestAMXPermission() error {
+	return nil
+}
@@ -0,0 +1,107 @@
+package cpuid
+
+import (
+	"path/filepath"
+	"testing"
+)
+
+// benchDumps are the checked-in captures the offline benchmarks read: a Sapphire Rapids
+// KVM guest, as written by CaptureData and converted to the binary format.
+var benchDumps = []struct{ name, file string }{
+	{"json", "testdata/spr_kvm.json"},
+	{"binary", "testdata/spr_kvm.bin"},
+}
+
+// benchSource is the data source of a benchmark run, with the values callers pass back in.
+type benchSource struct {
+	offline    bool
+	filename   string
+	maxFunc    uint32
+	maxExtFunc uint32
+	vendorID   string
+}
+
+func newBenchSource(offline bool, filename string) *benchSource {
+	s := &benchSource{offline: offline, filename: filename}
+	s.maxFunc, s.maxExtFunc = GetMaxFunctions(offline, filename)
+	s.vendorID = GetVendorID(offline, filename)
+	return s
+}
+
+// benchAPI runs fn in live mode and offline against each dump, serially and under RunParallel,
+// as sub-benchmarks named live/serial, json/parallel and so on.
+func benchAPI(b *testing.B, fn func(s *benchSource)) {
+	b.Run("live", func(b *testing.B) {
+		benchModes(b, newBenchSource(false, ""), fn)
+	})
+	for _, dump := range benchDumps {
+		if _, err := loadOffline(dump.file); err != nil {
+			b.Fatal(err)
+		}
+		b.Run(dump.name, func(b *testing.B) {
+			benchModes(b, newBenchSource(true, dump.file), fn)
+		})
+	}
+}
+
+func benchModes(b *testing.B, s *benchSource, fn func(s *benchSource)) {
+	b.Run("serial", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			fn(s)
+		}
+	})
+	b.Run("parallel", func(b *testing.B) {
+		b.ReportAllocs()
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				fn(s)
+			}
+		})
+	})
+}
+
+func BenchmarkGetVendorID(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetVendorID(s.offline, s.filename) })
+}
+
+func BenchmarkGetBrandString(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetBrandString(s.maxExtFunc, s.offline, s.filename) })
+}
+
+func BenchmarkGetModelData(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetModelData(s.offline, s.filename) })
+}
+
+func BenchmarkGetProcessorInfo(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetProcessorInfo(s.maxFunc, s.maxExtFunc, s.offline, s.filename) })
+}
+
+func BenchmarkGetCacheInfo(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetCacheInfo(s.maxFunc, s.maxExtFunc, s.vendorID, s.offline, s.filename) })
+}
+
+func BenchmarkGetTLBInfo(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetTLBInfo(s.maxFunc, s.maxExtFunc, s.offline, s.filename) })
+}
+
+func BenchmarkGetSupportedFeatures(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { GetSupportedFeatures("StandardECX", s.offline, s.filename) })
+}
+
+func BenchmarkIsFeatureSupported(b *testing.B) {
+	benchAPI(b, func(s *benchSource) { IsFeatureSupported("AVX2", s.offline, s.filename) })
+}
+
+// BenchmarkCaptureData captures the running CPU, so it has no offline or parallel variants.
+func BenchmarkCaptureData(b *testing.B) {
+	filename := filepath.Join(b.TempDir(), "cpuid_data.json")
+	b.Run("live/serial", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if err := CaptureData(filename); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
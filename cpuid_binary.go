@@ -0,0 +1,304 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"io"
+	"os"
+	"path/filepath"
+	"runtime"
+	"sort"
+	"sync"
+)
+
+// Binary dump layout, all values little endian:
+//
+//	Offset 0   [8]byte  magic "CPUIDDMP"
+//	Offset 8   uint32   format version
+//	Offset 12  uint32   record count
+//	Offset 16  uint32   record size (24)
+//	Offset 20  uint32   CRC-32C of the record area
+//	Offset 24  [8]byte  reserved, zero
+//	Offset 32  records: leaf, subleaf, eax, ebx, ecx, edx (uint32 each), sorted by leaf then subleaf
+const (
+	binaryMagic      = "CPUIDDMP"
+	binaryVersion    = 1
+	binaryHeaderSize = 32
+	binaryRecordSize = 24
+)
+
+var crcTable = crc32.MakeTable(crc32.Castagnoli)
+
+// BinaryDump is a read-only view of a binary dump file.
+// Lookups binary-search the mapped records and do not allocate.
+type BinaryDump struct {
+	data    []byte
+	records []byte
+	count   int
+	unmap   func([]byte) error
+
+	fingerprintOnce sync.Once
+	fingerprint     Fingerprint
+}
+
+// IsBinaryDump reports whether the file starts with the binary dump magic.
+func IsBinaryDump(filename string) bool {
+	file, err := os.Open(filename)
+	if err != nil {
+		return false
+	}
+	defer file.Close()
+
+	var magic [len(binaryMagic)]byte
+	if _, err := io.ReadFull(file, magic[:]); err != nil {
+		return false
+	}
+	return string(magic[:]) == binaryMagic
+}
+
+// OpenBinaryDump maps a binary dump file into memory and validates its header, checksum and record order.
+// The dump must be closed with Close once it is no longer used.
+func OpenBinaryDump(filename string) (*BinaryDump, error) {
+	file, err := os.Open(filename)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+
+	info, err := file.Stat()
+	if err != nil {
+		return nil, err
+	}
+	if info.Size() < binaryHeaderSize {
+		return nil, fmt.Errorf("%s: binary dump too short", filename)
+	}
+
+	data, unmap, err := mapFile(file, int(info.Size()))
+	if err != nil {
+		return nil, err
+	}
+
+	dump, err := parseBinaryDump(data)
+	if err != nil {
+		unmap(data)
+		return nil, fmt.Errorf("%s: %w", filename, err)
+	}
+	dump.unmap = unmap
+
+	return dump, nil
+}
+
+// parseBinaryDump validates the header, checksum and record order of an in-memory binary dump.
+func parseBinaryDump(data []byte) (*BinaryDump, error) {
+	if len(data) < binaryHeaderSize || string(data[:8]) != binaryMagic {
+		return nil, errors.New("not a binary cpuid dump")
+	}
+
+	version := binary.LittleEndian.Uint32(data[8:])
+	count := binary.LittleEndian.Uint32(data[12:])
+	recordSize := binary.LittleEndian.Uint32(data[16:])
+	checksum := binary.LittleEndian.Uint32(data[20:])
+
+	if version != binaryVersion {
+		return nil, fmt.Errorf("unsupported binary dump version %d", version)
+	}
+	if recordSize != binaryRecordSize {
+		return nil, fmt.Errorf("unsupported record size %d", recordSize)
+	}
+	if uint64(len(data)-binaryHeaderSize) != uint64(count)*binaryRecordSize {
+		return nil, errors.New("binary dump size does not match record count")
+	}
+
+	records := data[binaryHeaderSize:]
+	if crc32.Checksum(records, crcTable) != checksum {
+		return nil, errors.New("binary dump checksum mismatch")
+	}
+	// Lookup binary-searches the records and diffs merge them, so they must be strictly ascending.
+	var prev uint64
+	for i := 0; i < int(count); i++ {
+		r := records[i*binaryRecordSize:]
+		key := leafKey(binary.LittleEndian.Uint32(r[0:]), binary.LittleEndian.Uint32(r[4:]))
+		if i > 0 && key <= prev {
+			return nil, fmt.Errorf("binary dump record %d is out of order", i)
+		}
+		prev = key
+	}
+
+	return &BinaryDump{data: data, records: records, count: int(count)}, nil
+}
+
+// Close releases the mapping. The dump must not be used afterwards.
+func (d *BinaryDump) Close() error {
+	if d.unmap == nil || d.data == nil {
+		return nil
+	}
+	err := d.unmap(d.data)
+	d.data, d.records, d.count = nil, nil, 0
+	runtime.SetFinalizer(d, nil)
+	return err
+}
+
+// Len returns the number of records in the dump.
+func (d *BinaryDump) Len() int {
+	return d.count
+}
+
+// Entry returns the i-th record in (leaf, subleaf) order.
+func (d *BinaryDump) Entry(i int) Entry {
+	r := d.records[i*binaryRecordSize : (i+1)*binaryRecordSize]
+	return Entry{
+		Leaf:    binary.LittleEndian.Uint32(r[0:]),
+		Subleaf: binary.LittleEndian.Uint32(r[4:]),
+		EAX:     binary.LittleEndian.Uint32(r[8:]),
+		EBX:     binary.LittleEndian.Uint32(r[12:]),
+		ECX:     binary.LittleEndian.Uint32(r[16:]),
+		EDX:     binary.LittleEndian.Uint32(r[20:]),
+	}
+}
+
+// Lookup returns the registers stored for the given leaf and subleaf, and whether they were present.
+func (d *BinaryDump) Lookup(leaf, subleaf uint32) (a, b, c, dx uint32, ok bool) {
+	key := leafKey(leaf, subleaf)
+	lo, hi := 0, d.count
+	for lo < hi {
+		mid := int(uint(lo+hi) >> 1)
+		r := d.records[mid*binaryRecordSize:]
+		k := leafKey(binary.LittleEndian.Uint32(r[0:]), binary.LittleEndian.Uint32(r[4:]))
+		switch {
+		case k < key:
+			lo = mid + 1
+		case k > key:
+			hi = mid
+		default:
+			return binary.LittleEndian.Uint32(r[8:]), binary.LittleEndian.Uint32(r[12:]),
+				binary.LittleEndian.Uint32(r[16:]), binary.LittleEndian.Uint32(r[20:]), true
+		}
+	}
+	return 0, 0, 0, 0, false
+}
+
+// Data returns the dump records as a Data struct.
+func (d *BinaryDump) Data() Data {
+	entries := make([]Entry, d.count)
+	for i := range entries {
+		entries[i] = d.Entry(i)
+	}
+	return Data{Entries: entries}
+}
+
+// sortedEntries returns a copy of entries sorted by (leaf, subleaf), keeping the last of any duplicates.
+func sortedEntries(entries []Entry) []Entry {
+	sorted := make([]Entry, len(entries))
+	copy(sorted, entries)
+	sort.SliceStable(sorted, func(i, j int) bool {
+		return leafKey(sorted[i].Leaf, sorted[i].Subleaf) < leafKey(sorted[j].Leaf, sorted[j].Subleaf)
+	})
+
+	out := sorted[:0]
+	for i, e := range sorted {
+		if i+1 < len(sorted) && sorted[i+1].Leaf == e.Leaf && sorted[i+1].Subleaf == e.Subleaf {
+			continue
+		}
+		out = append(out, e)
+	}
+	return out
+}
+
+// MarshalBinary encodes the data in the binary dump format.
+func (data Data) MarshalBinary() ([]byte, error) {
+	entries := sortedEntries(data.Entries)
+
+	buf := make([]byte, binaryHeaderSize+len(entries)*binaryRecordSize)
+	copy(buf, binaryMagic)
+	binary.LittleEndian.PutUint32(buf[8:], binaryVersion)
+	binary.LittleEndian.PutUint32(buf[12:], uint32(len(entries)))
+	binary.LittleEndian.PutUint32(buf[16:], binaryRecordSize)
+
+	r := buf[binaryHeaderSize:]
+	for i, e := range entries {
+		rec := r[i*binaryRecordSize:]
+		binary.LittleEndian.PutUint32(rec[0:], e.Leaf)
+		binary.LittleEndian.PutUint32(rec[4:], e.Subleaf)
+		binary.LittleEndian.PutUint32(rec[8:], e.EAX)
+		binary.LittleEndian.PutUint32(rec[12:], e.EBX)
+		binary.LittleEndian.PutUint32(rec[16:], e.ECX)
+		binary.LittleEndian.PutUint32(rec[20:], e.EDX)
+	}
+	binary.LittleEndian.PutUint32(buf[20:], crc32.Checksum(r, crcTable))
+
+	return buf, nil
+}
+
+// UnmarshalBinary decodes data from the binary dump format.
+func (data *Data) UnmarshalBinary(buf []byte) error {
+	dump, err := parseBinaryDump(buf)
+	if err != nil {
+		return err
+	}
+	*data = dump.Data()
+	return nil
+}
+
+// WriteBinaryFile writes the data to filename in the binary dump format.
+// The file is written to a temporary name and renamed into place, so readers
+// that have the previous version mapped are not affected.
+func WriteBinaryFile(filename string, data Data) error {
+	buf, err := data.MarshalBinary()
+	if err != nil {
+		return err
+	}
+	return writeFileAtomic(filename, buf)
+}
+
+// writeFileAtomic writes buf to a temporary file next to filename and renames it into place.
+func writeFileAtomic(filename string, buf []byte) error {
+	tmp, err := os.CreateTemp(filepath.Dir(filename), filepath.Base(filename)+".tmp*")
+	if err != nil {
+		return err
+	}
+	if _, err := tmp.Write(buf); err != nil {
+		tmp.Close()
+		os.Remove(tmp.Name())
+		return err
+	}
+	if err := tmp.Chmod(0o644); err != nil {
+		tmp.Close()
+		os.Remove(tmp.Name())
+		return err
+	}
+	if err := tmp.Close(); err != nil {
+		os.Remove(tmp.Name())
+		return err
+	}
+
+	return os.Rename(tmp.Name(), filename)
+}
+
+// CaptureDataBinary traverses the full CPUID hierarchy and writes the data in the binary dump format.
+func CaptureDataBinary(filename string) error {
+	return WriteBinaryFile(filename, Data{Entries: captureEntries()})
+}
+
+// ConvertJSONToBinary reads a JSON dump and writes it in the binary dump format.
+func ConvertJSONToBinary(jsonFile, binaryFile string) error {
+	data, err := DataFromFile(jsonFile)
+	if err != nil {
+		return err
+	}
+	return WriteBinaryFile(binaryFile, data)
+}
+
+// ConvertBinaryToJSON reads a binary dump and writes it as a JSON dump.
+func ConvertBinaryToJSON(binaryFile, jsonFile string) error {
+	dump, err := OpenBinaryDump(binaryFile)
+	if err != nil {
+		return err
+	}
+	data := dump.Data()
+	dump.Close()
+
+	return writeJSONFile(jsonFile, data)
+}
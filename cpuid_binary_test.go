@@ -0,0 +1,153 @@
+package cpuid
+
+import (
+	"encoding/binary"
+	"encoding/json"
+	"hash/crc32"
+	"os"
+	"path/filepath"
+	"reflect"
+	"testing"
+)
+
+func TestBinaryDumpMatchesJSON(t *testing.T) {
+	data, err := DataFromFile("testdata/spr_kvm.json")
+	if err != nil {
+		t.Fatal(err)
+	}
+	dump, err := OpenBinaryDump("testdata/spr_kvm.bin")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer dump.Close()
+
+	want := sortedEntries(data.Entries)
+	if got := dump.Data().Entries; !reflect.DeepEqual(got, want) {
+		t.Fatalf("binary dump holds %d entries that differ from the %d JSON entries", len(got), len(want))
+	}
+	for _, e := range want {
+		a, b, c, d, ok := dump.Lookup(e.Leaf, e.Subleaf)
+		if !ok || a != e.EAX || b != e.EBX || c != e.ECX || d != e.EDX {
+			t.Errorf("Lookup(0x%X, %d) = %08x %08x %08x %08x %v, want %08x %08x %08x %08x",
+				e.Leaf, e.Subleaf, a, b, c, d, ok, e.EAX, e.EBX, e.ECX, e.EDX)
+		}
+	}
+
+	roundTrip := filepath.Join(t.TempDir(), "round_trip.json")
+	if err := ConvertBinaryToJSON("testdata/spr_kvm.bin", roundTrip); err != nil {
+		t.Fatal(err)
+	}
+	back, err := DataFromFile(roundTrip)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !reflect.DeepEqual(back.Entries, want) {
+		t.Errorf("binary to JSON conversion changed the entries")
+	}
+}
+
+// TestBinaryDumpRecordOrder rewrites records of a valid dump and fixes up the checksum:
+// records out of order or repeated would make Lookup miss entries, so they are rejected.
+func TestBinaryDumpRecordOrder(t *testing.T) {
+	data, err := DataFromFile("testdata/spr_kvm.json")
+	if err != nil {
+		t.Fatal(err)
+	}
+	valid, err := data.MarshalBinary()
+	if err != nil {
+		t.Fatal(err)
+	}
+	record := func(buf []byte, i int) []byte {
+		return buf[binaryHeaderSize+i*binaryRecordSize:][:binaryRecordSize]
+	}
+
+	for _, tc := range []struct {
+		name   string
+		modify func(buf []byte)
+	}{
+		{"swapped", func(buf []byte) {
+			a, b := record(buf, 3), record(buf, 4)
+			tmp := append([]byte(nil), a...)
+			copy(a, b)
+			copy(b, tmp)
+		}},
+		{"repeated", func(buf []byte) { copy(record(buf, 4), record(buf, 3)) }},
+		{"same key", func(buf []byte) { copy(record(buf, 4)[:8], record(buf, 3)[:8]) }},
+	} {
+		buf := append([]byte(nil), valid...)
+		tc.modify(buf)
+		binary.LittleEndian.PutUint32(buf[20:], crc32.Checksum(buf[binaryHeaderSize:], crcTable))
+		var back Data
+		if err := back.UnmarshalBinary(buf); err == nil {
+			t.Errorf("%s records: dump accepted", tc.name)
+		}
+	}
+
+	var back Data
+	if err := back.UnmarshalBinary(valid); err != nil {
+		t.Errorf("valid dump rejected: %v", err)
+	}
+}
+
+// BenchmarkLoadDump compares loading a dump into an indexed source: the binary format is
+// memory mapped and searched in place, JSON is parsed and indexed into a Snapshot.
+// encoding-json is the reflection-based decoder DataFromFile used before.
+func BenchmarkLoadDump(b *testing.B) {
+	b.Run("binary", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			dump, err := OpenBinaryDump("testdata/spr_kvm.bin")
+			if err != nil {
+				b.Fatal(err)
+			}
+			dump.Close()
+		}
+	})
+	b.Run("json", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			data, err := DataFromFile("testdata/spr_kvm.json")
+			if err != nil {
+				b.Fatal(err)
+			}
+			NewSnapshot(data.Entries)
+		}
+	})
+	b.Run("encoding-json", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			buf, err := os.ReadFile("testdata/spr_kvm.json")
+			if err != nil {
+				b.Fatal(err)
+			}
+			var data Data
+			if err := json.Unmarshal(buf, &data); err != nil {
+				b.Fatal(err)
+			}
+			NewSnapshot(data.Entries)
+		}
+	})
+}
+
+// BenchmarkLookup compares a lookup in a binary dump (binary search over the mapped records)
+// with one in a Snapshot (map index).
+func BenchmarkLookup(b *testing.B) {
+	dump, err := OpenBinaryDump("testdata/spr_kvm.bin")
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer dump.Close()
+	snap := NewSnapshot(dump.Data().Entries)
+
+	for _, src := range []struct {
+		name string
+		src  leafSource
+	}{{"binary", dump}, {"snapshot", snap}} {
+		b.Run(src.name, func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				src.src.Lookup(0x80000004, 0)
+			}
+		})
+	}
+}
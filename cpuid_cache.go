@@ -3,19 +3,21 @@ package cpuid
 
 import (
 	"fmt"
-	"strings"
 )
 
-// GetCacheInfo returns cache information for the CPU
+// GetCacheInfo returns cache information for the CPU.
+// If vendorID is not a recognised leaf 0 vendor string, the vendor of the data source is used.
 func GetCacheInfo(maxFunc, maxExtFunc uint32, vendorID string, offline bool, filename string) ([]CPUCacheInfo, error) {
-	isIntel := strings.Contains(strings.ToUpper(vendorID), "INTEL")
-	isAMD := strings.Contains(strings.ToUpper(vendorID), "AMD")
+	vendor := VendorFromID(vendorID)
+	if vendor == VendorUnknown {
+		vendor = GetVendor(offline, filename)
+	}
 
-	if isAMD {
+	if vendor.AMDCompatible() {
 		return GetAMDCache(maxExtFunc, offline, filename), nil
 	}
 
-	if isIntel {
+	if vendor.IntelCompatible() {
 		return GetIntelCache(maxFunc, offline, filename), nil
 	}
 
@@ -28,15 +30,7 @@ func GetAMDCache(maxExtFunc uint32, offline bool, filename string) []CPUCacheInf
 		return nil
 	}
 
-	var caches []CPUCacheInfo
-	for i := uint32(0); ; i++ {
-		info := GetCPUCacheDetails(0x8000001D, i, offline, filename)
-		if info.Type == getCacheTypeString(0) {
-			break
-		}
-		caches = append(caches, info)
-	}
-	return caches
+	return cachesOfLeaf(0x8000001D, modeGetter(offline, filename))
 }
 
 // GetIntelCache returns cache information for Intel processors
@@ -45,20 +39,46 @@ func GetIntelCache(maxFunc uint32, offline bool, filename string) []CPUCacheInfo
 		return nil
 	}
 
+	return cachesOfLeaf(4, modeGetter(offline, filename))
+}
+
+// cachesOfLeaf decodes the subleaves of a deterministic cache parameters leaf (4 or 0x8000001D).
+func cachesOfLeaf(leaf uint32, get func(leaf, subleaf uint32) (a, b, c, d uint32)) []CPUCacheInfo {
 	var caches []CPUCacheInfo
-	for i := uint32(0); ; i++ {
-		info := GetCPUCacheDetails(4, i, offline, filename)
-		if info.Type == getCacheTypeString(0) {
-			break
+	forEachSubleaf(leaf, get, func(_, a, b, c, _ uint32) bool {
+		if a&0x1F == 0 {
+			return false
 		}
-		caches = append(caches, info)
-	}
+		caches = append(caches, cacheInfoFromRegisters(a, b, c))
+		return true
+	})
 	return caches
 }
 
+// cachesOf decodes the caches read through get, choosing the leaf by the vendor as GetCacheInfo does.
+func cachesOf(get func(leaf, subleaf uint32) (a, b, c, d uint32)) []CPUCacheInfo {
+	maxFunc, b, c, d := get(0, 0)
+	switch vendor := vendorFromRegisters(b, c, d); {
+	case vendor.AMDCompatible():
+		if maxExtFunc, _, _, _ := get(0x80000000, 0); maxExtFunc >= 0x8000001D {
+			return cachesOfLeaf(0x8000001D, get)
+		}
+	case vendor.IntelCompatible():
+		if maxFunc >= 4 {
+			return cachesOfLeaf(4, get)
+		}
+	}
+	return nil
+}
+
 // GetCPUCacheDetails returns detailed information about the CPU cache.
 func GetCPUCacheDetails(leaf, subLeaf uint32, offline bool, filename string) CPUCacheInfo {
 	a, b, c, _ := CPUIDWithMode(leaf, subLeaf, offline, filename)
+	return cacheInfoFromRegisters(a, b, c)
+}
+
+// cacheInfoFromRegisters decodes the registers of one leaf 4 or 0x8000001D subleaf.
+func cacheInfoFromRegisters(a, b, c uint32) CPUCacheInfo {
 	cacheType := a & 0x1F
 	level := (a >> 5) & 0x7
 	lineSize := (b & 0xFFF) + 1
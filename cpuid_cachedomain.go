@@ -0,0 +1,114 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"fmt"
+	"sort"
+)
+
+// CacheDomain is one instance of a cache together with the logical CPUs that share it.
+type CacheDomain struct {
+	CPUCacheInfo
+	Index int    // instance number among the caches of the same level and type, ordered by lowest CPU
+	ID    uint32 // APIC ID of the sharing CPUs shifted right by the cache's sharing width
+	CPUs  CPUSet
+}
+
+// String describes the domain, e.g. "L3 Unified #1: CPUs 0-15,64-79".
+func (d CacheDomain) String() string {
+	return fmt.Sprintf("L%d %s #%d: CPUs %s", d.Level, d.Type, d.Index, d.CPUs)
+}
+
+// cacheDomainKey identifies a cache instance: the cache (by subleaf) and the shared APIC ID prefix.
+type cacheDomainKey struct {
+	subleaf uint32
+	id      uint32
+}
+
+// GetCacheDomains returns every cache instance of the data source and the CPUs that share it,
+// ordered by level, type and lowest CPU. It uses the same per-CPU data as GetTopology and is
+// cached with the data source; the returned slice is shared and must not be modified.
+func GetCacheDomains(offline bool, filename string) ([]CacheDomain, error) {
+	d, nums, srcs, err := perCPUSources(offline, filename)
+	if err != nil {
+		return nil, err
+	}
+	d.cacheOnce.Do(func() {
+		d.caches = newCacheDomains(nums, srcs)
+	})
+	return d.caches, nil
+}
+
+// CacheDomainsFromSnapshots computes the cache domains of a per-CPU capture.
+func CacheDomainsFromSnapshots(cpus CPUSnapshots) []CacheDomain {
+	nums := cpus.CPUs()
+	srcs := make([]leafSource, len(nums))
+	for i, cpu := range nums {
+		srcs[i] = cpus[cpu]
+	}
+	return newCacheDomains(nums, srcs)
+}
+
+// newCacheDomains groups the CPUs by cache instance. A cache's EAX[25:14] gives the number of
+// APIC IDs that share it, rounded up to a power of two; CPUs whose APIC IDs agree above those
+// bits share the same instance.
+func newCacheDomains(nums []int, srcs []leafSource) []CacheDomain {
+	var domains []CacheDomain
+	index := map[cacheDomainKey]int{}
+
+	for i, cpu := range nums {
+		src := srcs[i]
+		_, apicID, _ := decodeTopology(src)
+		leaf := cacheLeaf(src)
+		if leaf == 0 {
+			continue
+		}
+
+		forEachSubleaf(leaf, sourceGetter(src), func(subleaf, a, b, c, _ uint32) bool {
+			if a&0x1F == 0 {
+				return false
+			}
+			id := apicID >> ceilLog2((a>>14)&0xFFF+1)
+			key := cacheDomainKey{subleaf, id}
+			n, ok := index[key]
+			if !ok {
+				n = len(domains)
+				index[key] = n
+				domains = append(domains, CacheDomain{CPUCacheInfo: cacheInfoFromRegisters(a, b, c), ID: id})
+			}
+			domains[n].CPUs.Add(cpu)
+			return true
+		})
+	}
+
+	// CPUs are visited in ascending order, so a stable sort keeps each level and type ordered by lowest CPU.
+	sort.SliceStable(domains, func(i, j int) bool {
+		if domains[i].Level != domains[j].Level {
+			return domains[i].Level < domains[j].Level
+		}
+		return domains[i].Type < domains[j].Type
+	})
+	for i := range domains {
+		if i > 0 && domains[i].Level == domains[i-1].Level && domains[i].Type == domains[i-1].Type {
+			domains[i].Index = domains[i-1].Index + 1
+		}
+	}
+	return domains
+}
+
+// cacheLeaf returns the deterministic cache parameters leaf of a CPU (0x8000001D on AMD, 4 otherwise),
+// or 0 if it has none.
+func cacheLeaf(src leafSource) uint32 {
+	maxStd, b, c, d, _ := src.Lookup(0, 0)
+	if vendorFromRegisters(b, c, d).AMDCompatible() {
+		maxExt, _, _, _, _ := src.Lookup(0x80000000, 0)
+		if maxExt >= 0x8000001D {
+			return 0x8000001D
+		}
+		return 0
+	}
+	if maxStd >= 4 {
+		return 4
+	}
+	return 0
+}
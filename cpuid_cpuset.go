@@ -0,0 +1,89 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"math/bits"
+	"strconv"
+	"strings"
+)
+
+// CPUSet is a set of Linux CPU numbers stored in the sched_setaffinity mask layout:
+// CPU n is bit n%64 of word n/64.
+type CPUSet []uint64
+
+// CPUSetOf returns the set holding the given CPUs.
+func CPUSetOf(cpus ...int) CPUSet {
+	var s CPUSet
+	for _, cpu := range cpus {
+		s.Add(cpu)
+	}
+	return s
+}
+
+// ParseCPUSet parses a Linux CPU list such as "0-15,64-79".
+func ParseCPUSet(list string) (CPUSet, error) {
+	cpus, err := parseCPUList(list)
+	if err != nil {
+		return nil, err
+	}
+	return CPUSetOf(cpus...), nil
+}
+
+// Add adds a CPU to the set. Negative CPU numbers are ignored.
+func (s *CPUSet) Add(cpu int) {
+	if cpu < 0 {
+		return
+	}
+	for len(*s) <= cpu/64 {
+		*s = append(*s, 0)
+	}
+	(*s)[cpu/64] |= 1 << (uint(cpu) % 64)
+}
+
+// Has reports whether the CPU is in the set.
+func (s CPUSet) Has(cpu int) bool {
+	return cpu >= 0 && cpu/64 < len(s) && s[cpu/64]&(1<<(uint(cpu)%64)) != 0
+}
+
+// Count returns the number of CPUs in the set.
+func (s CPUSet) Count() int {
+	n := 0
+	for _, w := range s {
+		n += bits.OnesCount64(w)
+	}
+	return n
+}
+
+// CPUs returns the CPUs in the set in ascending order.
+func (s CPUSet) CPUs() []int {
+	cpus := make([]int, 0, s.Count())
+	for i, w := range s {
+		for w != 0 {
+			cpus = append(cpus, i*64+bits.TrailingZeros64(w))
+			w &= w - 1
+		}
+	}
+	return cpus
+}
+
+// String formats the set as a Linux CPU list, e.g. "0-15,64-79".
+func (s CPUSet) String() string {
+	var sb strings.Builder
+	cpus := s.CPUs()
+	for i := 0; i < len(cpus); {
+		j := i
+		for j+1 < len(cpus) && cpus[j+1] == cpus[j]+1 {
+			j++
+		}
+		if sb.Len() > 0 {
+			sb.WriteByte(',')
+		}
+		sb.WriteString(strconv.Itoa(cpus[i]))
+		if j > i {
+			sb.WriteByte('-')
+			sb.WriteString(strconv.Itoa(cpus[j]))
+		}
+		i = j + 1
+	}
+	return sb.String()
+}
@@ -0,0 +1,267 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"fmt"
+	"math/bits"
+	"strings"
+	"sync"
+)
+
+// SnapshotDiff lists the differences between two captures: the registers of each changed
+// (leaf, subleaf), the named feature bits that changed and the changes in the decoded caches,
+// TLBs and topology widths. The per-CPU and OS-dependent fields that Fingerprint masks are ignored,
+// so captures taken on different CPUs of one host compare equal.
+type SnapshotDiff struct {
+	Leaves   []LeafDiff
+	Features []FeatureChange
+	Caches   []DecodedChange
+	TLBs     []DecodedChange
+	Topology []DecodedChange
+}
+
+// LeafDiff is a (leaf, subleaf) whose registers differ. A subleaf missing from a capture reads as zeros.
+type LeafDiff struct {
+	Leaf    uint32
+	Subleaf uint32
+	Before  [4]uint32 // EAX, EBX, ECX, EDX
+	After   [4]uint32
+	Changed [4]uint32 // Before XOR After, without the masked per-CPU fields
+}
+
+// FeatureChange is a named feature bit that is set in only one of the captures.
+// A bit is named after the feature IsFeatureSupported resolves from it.
+type FeatureChange struct {
+	Name     string
+	Leaf     uint32
+	Subleaf  uint32
+	Register int // 0=EAX, 1=EBX, 2=ECX, 3=EDX
+	Bit      uint
+	Added    bool // set in the second capture, cleared in the first
+}
+
+// DecodedChange is a decoded cache, TLB or topology value that differs. Before or After is
+// empty if only one capture has the item.
+type DecodedChange struct {
+	Name   string
+	Before string
+	After  string
+}
+
+// Empty reports whether the captures compare equal.
+func (d *SnapshotDiff) Empty() bool {
+	return len(d.Leaves) == 0
+}
+
+// DiffSnapshots compares two snapshots.
+func DiffSnapshots(before, after *Snapshot) SnapshotDiff {
+	return diffSources(before, after)
+}
+
+// DiffFiles compares two dump files (JSON or binary). The files are loaded once and cached
+// as in offline mode, so diffing many pairs against one baseline reads the baseline once.
+func DiffFiles(before, after string) (SnapshotDiff, error) {
+	a, err := loadOffline(before)
+	if err != nil {
+		return SnapshotDiff{}, err
+	}
+	b, err := loadOffline(after)
+	if err != nil {
+		return SnapshotDiff{}, err
+	}
+	return diffSources(a.src, b.src), nil
+}
+
+// diffSources merges the entries of both sources in (leaf, subleaf) order and decodes the caches,
+// TLBs and topology only if some register differs.
+func diffSources(before, after leafSource) SnapshotDiff {
+	var diff SnapshotDiff
+	ea, eb := entriesOf(before), entriesOf(after)
+	for i, j := 0, 0; i < len(ea) || j < len(eb); {
+		var a, b Entry
+		switch {
+		case j == len(eb) || i < len(ea) && leafKey(ea[i].Leaf, ea[i].Subleaf) < leafKey(eb[j].Leaf, eb[j].Subleaf):
+			a = ea[i]
+			b = Entry{Leaf: a.Leaf, Subleaf: a.Subleaf}
+			i++
+		case i == len(ea) || leafKey(eb[j].Leaf, eb[j].Subleaf) < leafKey(ea[i].Leaf, ea[i].Subleaf):
+			b = eb[j]
+			a = Entry{Leaf: b.Leaf, Subleaf: b.Subleaf}
+			j++
+		default:
+			a, b = ea[i], eb[j]
+			i++
+			j++
+		}
+		diff.addLeaf(a, b)
+	}
+	if diff.Empty() {
+		return diff
+	}
+
+	diff.diffCaches(cachesOf(sourceGetter(before)), cachesOf(sourceGetter(after)))
+	ta, _ := tlbInfoOf(sourceGetter(before))
+	tb, _ := tlbInfoOf(sourceGetter(after))
+	diff.diffTLBs(ta, tb)
+	sa, _, _ := decodeTopology(before)
+	sb, _, _ := decodeTopology(after)
+	for l := LevelCore; l < numTopologyLevels; l++ {
+		if sa[l] != sb[l] {
+			diff.Topology = append(diff.Topology, DecodedChange{
+				Name:   fmt.Sprintf("%s ID shift", l),
+				Before: fmt.Sprint(sa[l]),
+				After:  fmt.Sprint(sb[l]),
+			})
+		}
+	}
+	return diff
+}
+
+// entriesOf returns the entries of a source sorted by (leaf, subleaf) without duplicates.
+// Binary dumps are stored in that order.
+func entriesOf(src leafSource) []Entry {
+	switch s := src.(type) {
+	case *Snapshot:
+		return sortedEntries(s.entries)
+	case *BinaryDump:
+		return s.Data().Entries
+	}
+	return nil
+}
+
+// addLeaf records a (leaf, subleaf) if its registers differ outside the per-CPU fields,
+// with the named feature bits among the changed ones.
+func (diff *SnapshotDiff) addLeaf(a, b Entry) {
+	before := [4]uint32{a.EAX, a.EBX, a.ECX, a.EDX}
+	after := [4]uint32{b.EAX, b.EBX, b.ECX, b.EDX}
+	if before == after {
+		return
+	}
+	ma, mb, mc, md := maskPerCPU(a.Leaf, a.Subleaf, before[0]^after[0], before[1]^after[1], before[2]^after[2], before[3]^after[3])
+	changed := [4]uint32{ma, mb, mc, md}
+	if changed == [4]uint32{} {
+		return
+	}
+	diff.Leaves = append(diff.Leaves, LeafDiff{Leaf: a.Leaf, Subleaf: a.Subleaf, Before: before, After: after, Changed: changed})
+
+	names := featureBitsAt()[leafKey(a.Leaf, a.Subleaf)]
+	if names == nil {
+		return
+	}
+	for reg, x := range changed {
+		for ; x != 0; x &= x - 1 {
+			bit := uint(bits.TrailingZeros32(x))
+			if id := names[reg][bit]; id != 0 {
+				diff.Features = append(diff.Features, FeatureChange{
+					Name:     featureNames[id-1],
+					Leaf:     a.Leaf,
+					Subleaf:  a.Subleaf,
+					Register: reg,
+					Bit:      bit,
+					Added:    after[reg]>>bit&1 != 0,
+				})
+			}
+		}
+	}
+}
+
+var (
+	featureBitsOnce sync.Once
+	featureBits     map[uint64]*[4][32]uint16 // leafKey -> register -> bit -> FeatureID+1
+)
+
+// featureBitsAt returns the feature index by register bit, built on first use. A feature is
+// indexed at the definitions computeFeatureMask may resolve it from: the first one in lookup
+// order, and the following ones while the sets before them have a condition that may fail.
+// So a bit is named after the feature IsFeatureSupported reads from it.
+func featureBitsAt() map[uint64]*[4][32]uint16 {
+	featureBitsOnce.Do(func() {
+		featureBits = make(map[uint64]*[4][32]uint16)
+		for id, descs := range featureDescs {
+			for _, d := range descs {
+				fs := featureSets[d.set]
+				if fs.register >= 0 && fs.register <= 3 && d.bit < 32 {
+					key := leafKey(fs.leaf, fs.subleaf)
+					slots := featureBits[key]
+					if slots == nil {
+						slots = new([4][32]uint16)
+						featureBits[key] = slots
+					}
+					if slots[fs.register][d.bit] == 0 {
+						slots[fs.register][d.bit] = uint16(id) + 1
+					}
+				}
+				if fs.condition == nil {
+					break
+				}
+			}
+		}
+	})
+	return featureBits
+}
+
+// diffCaches pairs the caches by level and type.
+func (diff *SnapshotDiff) diffCaches(before, after []CPUCacheInfo) {
+	matched := make([]bool, len(after))
+	for _, a := range before {
+		name := fmt.Sprintf("L%d %s cache", a.Level, a.Type)
+		change := DecodedChange{Name: name, Before: describeCache(a)}
+		for j, b := range after {
+			if !matched[j] && b.Level == a.Level && b.Type == a.Type {
+				matched[j] = true
+				if b == a {
+					change.Before = ""
+				} else {
+					change.After = describeCache(b)
+				}
+				break
+			}
+		}
+		if change.Before != "" {
+			diff.Caches = append(diff.Caches, change)
+		}
+	}
+	for j, b := range after {
+		if !matched[j] {
+			diff.Caches = append(diff.Caches, DecodedChange{Name: fmt.Sprintf("L%d %s cache", b.Level, b.Type), After: describeCache(b)})
+		}
+	}
+}
+
+func describeCache(c CPUCacheInfo) string {
+	return fmt.Sprintf("%d KB, %d-way, %d B lines, %d sets, shared by up to %d", c.SizeKB, c.Ways, c.LineSizeBytes, c.TotalSets, c.MaxCoresSharing)
+}
+
+// diffTLBs compares the TLBs of each level and type.
+func (diff *SnapshotDiff) diffTLBs(before, after TLBInfo) {
+	levels := [...]struct {
+		name string
+		a, b TLBLevel
+	}{{"L1", before.L1, after.L1}, {"L2", before.L2, after.L2}, {"L3", before.L3, after.L3}}
+	for _, l := range levels {
+		diff.diffTLBEntries(l.name+" Data TLB", l.a.Data, l.b.Data)
+		diff.diffTLBEntries(l.name+" Instruction TLB", l.a.Instruction, l.b.Instruction)
+		diff.diffTLBEntries(l.name+" Unified TLB", l.a.Unified, l.b.Unified)
+	}
+}
+
+func (diff *SnapshotDiff) diffTLBEntries(name string, before, after []TLBEntry) {
+	if len(before) == len(after) {
+		equal := true
+		for i := range before {
+			equal = equal && before[i] == after[i]
+		}
+		if equal {
+			return
+		}
+	}
+	diff.TLBs = append(diff.TLBs, DecodedChange{Name: name, Before: describeTLB(before), After: describeTLB(after)})
+}
+
+func describeTLB(entries []TLBEntry) string {
+	parts := make([]string, len(entries))
+	for i, e := range entries {
+		parts[i] = fmt.Sprintf("%d x %s %s", e.Entries, e.PageSize, e.Associativity)
+	}
+	return strings.Join(parts, "; ")
+}
@@ -0,0 +1,173 @@
+package cpuid
+
+import (
+	"fmt"
+	"testing"
+)
+
+func TestDiffFilesSameCapture(t *testing.T) {
+	diff, err := DiffFiles("testdata/spr_kvm.json", "testdata/spr_kvm.bin")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !diff.Empty() {
+		t.Errorf("JSON and binary dumps of one capture differ: %+v", diff)
+	}
+}
+
+// TestDiffIgnoresPerCPUFields compares the capture with a copy another logical CPU could have
+// written with the OS state disabled.
+func TestDiffIgnoresPerCPUFields(t *testing.T) {
+	entries := sprKVMEntries(t)
+	for i := range entries {
+		e := &entries[i]
+		switch e.Leaf {
+		case 1:
+			e.EBX ^= 0x2A << 24 // initial APIC ID
+			e.ECX &^= 1 << 27   // OSXSAVE
+		case 0xB, 0x1F:
+			e.EDX ^= 0x2A // x2APIC ID
+		}
+	}
+	diff, err := DiffFiles("testdata/spr_kvm.json", writeWriter16Dump(t, entries))
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !diff.Empty() {
+		t.Errorf("captures differing only in per-CPU fields differ: %+v", diff)
+	}
+}
+
+func TestDiffFeatureCleared(t *testing.T) {
+	entries := sprKVMEntries(t)
+	before := NewSnapshot(entries)
+	for i := range entries {
+		if entries[i].Leaf == 7 && entries[i].Subleaf == 0 {
+			entries[i].EBX &^= 1 << 16 // AVX512F
+		}
+	}
+	diff := DiffSnapshots(before, NewSnapshot(entries))
+	if len(diff.Leaves) != 1 || diff.Leaves[0].Leaf != 7 || diff.Leaves[0].Changed != [4]uint32{1: 1 << 16} {
+		t.Errorf("Leaves = %+v, want leaf 7 EBX bit 16", diff.Leaves)
+	}
+	want := []FeatureChange{{Name: "AVX512F", Leaf: 7, Register: 1, Bit: 16}}
+	if fmt.Sprint(diff.Features) != fmt.Sprint(want) {
+		t.Errorf("Features = %+v, want %+v", diff.Features, want)
+	}
+	if len(diff.Caches) != 0 || len(diff.TLBs) != 0 || len(diff.Topology) != 0 {
+		t.Errorf("a feature bit changed decoded values: %+v", diff)
+	}
+}
+
+func TestDiffCacheLeaf(t *testing.T) {
+	entries := sprKVMEntries(t)
+	before := NewSnapshot(entries)
+	changed := false
+	for i := range entries {
+		e := &entries[i]
+		if e.Leaf == 4 && (e.EAX>>5)&7 == 2 { // the L2 cache: one more way
+			e.EBX += 1 << 22
+			changed = true
+		}
+	}
+	if !changed {
+		t.Fatal("spr_kvm.json has no L2 in leaf 4")
+	}
+	diff := DiffSnapshots(before, NewSnapshot(entries))
+	if len(diff.Caches) != 1 || diff.Caches[0].Name != "L2 Unified cache" || diff.Caches[0].Before == diff.Caches[0].After {
+		t.Errorf("Caches = %+v, want the L2 cache", diff.Caches)
+	}
+	if len(diff.Features) != 0 {
+		t.Errorf("Features = %+v, want none", diff.Features)
+	}
+}
+
+// TestDiffFeatureNamesMatchIsFeatureSupported flips every bit of leaves 1 and 7.0 in turn and checks
+// that each feature the diff names changes IsFeatureSupported between the two dumps.
+func TestDiffFeatureNamesMatchIsFeatureSupported(t *testing.T) {
+	base := []Entry{intelLeaf0, {Leaf: 1}, {Leaf: 7}}
+	baseFile := writeDump(t, base)
+	for i := 1; i < len(base); i++ {
+		for reg := 0; reg < 4; reg++ {
+			for bit := uint(0); bit < 32; bit++ {
+				flipped := append([]Entry(nil), base...)
+				regs := [4]*uint32{&flipped[i].EAX, &flipped[i].EBX, &flipped[i].ECX, &flipped[i].EDX}
+				*regs[reg] = 1 << bit
+				where := fmt.Sprintf("leaf 0x%X register %d bit %d", flipped[i].Leaf, reg, bit)
+
+				diff := DiffSnapshots(NewSnapshot(base), NewSnapshot(flipped))
+				if len(diff.Features) == 0 {
+					continue
+				}
+				flippedFile := writeDump(t, flipped)
+				for _, f := range diff.Features {
+					if !f.Added || f.Register != reg || f.Bit != bit {
+						t.Errorf("%s: diff reports %+v", where, f)
+					}
+					if IsFeatureSupported(f.Name, true, baseFile) == IsFeatureSupported(f.Name, true, flippedFile) {
+						t.Errorf("%s: diff names %s, which IsFeatureSupported does not read there", where, f.Name)
+					}
+				}
+			}
+		}
+	}
+}
+
+func TestDiffAMXBF16Bit(t *testing.T) {
+	base := NewSnapshot([]Entry{intelLeaf0, {Leaf: 7}})
+	for _, tc := range []struct {
+		name string
+		leaf Entry
+		want bool
+	}{
+		{"7.0:ECX[24]", Entry{Leaf: 7, ECX: 1 << 24}, false},
+		{"7.0:EDX[22]", Entry{Leaf: 7, EDX: 1 << 22}, true},
+	} {
+		diff := DiffSnapshots(base, NewSnapshot([]Entry{intelLeaf0, tc.leaf}))
+		named := false
+		for _, f := range diff.Features {
+			named = named || f.Name == "AMX_BF16"
+		}
+		if named != tc.want {
+			t.Errorf("flipping %s: AMX_BF16 reported %v, want %v", tc.name, named, tc.want)
+		}
+	}
+}
+
+// BenchmarkDiffSnapshots compares a capture with an identical one and with one that lacks AVX512F,
+// which also decodes the caches, TLBs and topology of both.
+func BenchmarkDiffSnapshots(b *testing.B) {
+	data, err := DataFromFile("testdata/spr_kvm.json")
+	if err != nil {
+		b.Fatal(err)
+	}
+	before := NewSnapshot(data.Entries)
+	entries := append([]Entry(nil), data.Entries...)
+	for i := range entries {
+		if entries[i].Leaf == 7 && entries[i].Subleaf == 0 {
+			entries[i].EBX &^= 1 << 16
+		}
+	}
+	for _, after := range []struct {
+		name string
+		s    *Snapshot
+	}{{"identical", NewSnapshot(data.Entries)}, {"changed", NewSnapshot(entries)}} {
+		b.Run(after.name, func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				DiffSnapshots(before, after.s)
+			}
+		})
+	}
+}
+
+// BenchmarkDiffFiles diffs the JSON dump against the binary one; both stay in the offline cache,
+// as a baseline does when a fleet is diffed against it.
+func BenchmarkDiffFiles(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		if _, err := DiffFiles("testdata/spr_kvm.json", "testdata/spr_kvm.bin"); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
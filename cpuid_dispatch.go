@@ -0,0 +1,134 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"fmt"
+	"os"
+	"strings"
+	"sync"
+	"sync/atomic"
+)
+
+// DispatchEnv names the environment variable that forces dispatch choices, e.g.
+// CPUID_DISPATCH="checksum=sse42,matmul=generic". A forced variant is only used if the CPU
+// can use it, so the override can pick slower variants for A/B tests but never unsafe ones.
+const DispatchEnv = "CPUID_DISPATCH"
+
+// Dispatch selects one of several implementations of a function by the features of the CPU
+// the program runs on. Variants are registered with the features they require and a priority;
+// the first Get picks the highest priority variant whose features are all usable (supported
+// by the CPU and enabled by the OS, see GetUsableFeatureMask) and stores it, so later calls
+// cost an atomic load and an indirect call.
+//
+// A Dispatch is typically a package-level variable:
+//
+//	var sum = cpuid.NewDispatch[func([]float32) float32]("sum").
+//		Register("generic", 0, sumGeneric).
+//		Register("avx2", 10, sumAVX2, "AVX2", "FMA")
+//
+//	func Sum(x []float32) float32 { return sum.Get()(x) }
+//
+// Get is not inlined (generic methods go through a dictionary), so calling through it costs
+// a call, an atomic load and a nil check more than calling a function variable; about 0.5ns
+// in BenchmarkDispatchGet. Hot paths can resolve once and keep the result, which makes each
+// call a plain indirect call:
+//
+//	var sumImpl = sum.Get()
+//
+//	func Sum(x []float32) float32 { return sumImpl(x) }
+type Dispatch[F any] struct {
+	name     string
+	mu       sync.Mutex
+	variants []dispatchVariant[F]
+	chosen   atomic.Pointer[dispatchVariant[F]]
+}
+
+type dispatchVariant[F any] struct {
+	name     string
+	priority int
+	impl     F
+	features FeatureMask
+}
+
+// NewDispatch returns an empty dispatcher. name identifies it in the DispatchEnv override.
+func NewDispatch[F any](name string) *Dispatch[F] {
+	return &Dispatch[F]{name: name}
+}
+
+// Register adds a variant that requires all of the given features (names as used by
+// IsFeatureSupported) and returns the dispatcher for chaining. A variant without features is
+// a fallback that always applies. Among equal priorities the first registered wins.
+// Register panics on unknown feature names and when called after the dispatcher was resolved.
+func (d *Dispatch[F]) Register(variant string, priority int, impl F, features ...string) *Dispatch[F] {
+	mask, err := FeatureMaskOf(features...)
+	if err != nil {
+		panic(fmt.Sprintf("cpuid: dispatch %s/%s: %v", d.name, variant, err))
+	}
+
+	d.mu.Lock()
+	defer d.mu.Unlock()
+	if d.chosen.Load() != nil {
+		panic(fmt.Sprintf("cpuid: dispatch %s: variant %s registered after first use", d.name, variant))
+	}
+	d.variants = append(d.variants, dispatchVariant[F]{name: variant, priority: priority, impl: impl, features: mask})
+	return d
+}
+
+// Get returns the selected implementation, resolving it on first use.
+// It panics if no registered variant is usable.
+func (d *Dispatch[F]) Get() F {
+	if v := d.chosen.Load(); v != nil {
+		return v.impl
+	}
+	return d.resolve().impl
+}
+
+// Selected returns the name of the selected variant, resolving it on first use.
+func (d *Dispatch[F]) Selected() string {
+	if v := d.chosen.Load(); v != nil {
+		return v.name
+	}
+	return d.resolve().name
+}
+
+func (d *Dispatch[F]) resolve() *dispatchVariant[F] {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+	if v := d.chosen.Load(); v != nil {
+		return v
+	}
+
+	cpu := GetUsableFeatureMask(false, "")
+	forced := dispatchOverride(d.name)
+
+	var best *dispatchVariant[F]
+	for i := range d.variants {
+		v := &d.variants[i]
+		if !cpu.HasAll(v.features) {
+			continue
+		}
+		if v.name == forced {
+			best = v
+			break
+		}
+		if best == nil || v.priority > best.priority {
+			best = v
+		}
+	}
+	if best == nil {
+		panic(fmt.Sprintf("cpuid: dispatch %s: no registered variant is usable on this CPU", d.name))
+	}
+
+	d.chosen.Store(best)
+	return best
+}
+
+// dispatchOverride returns the variant DispatchEnv forces for the named dispatcher, if any.
+func dispatchOverride(name string) string {
+	for _, kv := range strings.Split(os.Getenv(DispatchEnv), ",") {
+		if k, v, ok := strings.Cut(strings.TrimSpace(kv), "="); ok && k == name {
+			return v
+		}
+	}
+	return ""
+}
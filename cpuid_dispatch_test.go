@@ -0,0 +1,84 @@
+package cpuid
+
+import "testing"
+
+func dispatchGeneric(x []float32) (s float32) {
+	for _, v := range x {
+		s += v
+	}
+	return s
+}
+
+func dispatchFast(x []float32) float32 { return dispatchGeneric(x) }
+
+func TestDispatchSelection(t *testing.T) {
+	usable := GetUsableFeatureMask(false, "")
+	if !usable.Has(featureIDs["SSE2"]) {
+		t.Skip("needs SSE2")
+	}
+	unusable := ""
+	for _, name := range featureNames {
+		if !usable.Has(featureIDs[name]) {
+			unusable = name
+			break
+		}
+	}
+	if unusable == "" {
+		t.Skip("every known feature is usable")
+	}
+
+	d := NewDispatch[func([]float32) float32]("test_sum").
+		Register("generic", 0, dispatchGeneric).
+		Register("sse2", 10, dispatchFast, "SSE2").
+		Register("unusable", 20, dispatchFast, unusable)
+	if got := d.Selected(); got != "sse2" {
+		t.Errorf("Selected() = %q, want sse2", got)
+	}
+	if got := d.Get()([]float32{1, 2, 3}); got != 6 {
+		t.Errorf("Get()(1, 2, 3) = %v, want 6", got)
+	}
+
+	t.Setenv(DispatchEnv, "other=x, test_forced=generic")
+	forced := NewDispatch[func([]float32) float32]("test_forced").
+		Register("generic", 0, dispatchGeneric).
+		Register("sse2", 10, dispatchFast, "SSE2")
+	if got := forced.Selected(); got != "generic" {
+		t.Errorf("Selected() with %s = %q, want generic", DispatchEnv, got)
+	}
+
+	defer func() {
+		if recover() == nil {
+			t.Error("Register after Get did not panic")
+		}
+	}()
+	d.Register("late", 30, dispatchFast)
+}
+
+// dispatchFuncPtr and dispatchStored are package-level function variables, as a program would
+// keep them, so the compiler cannot turn calls through them into direct, inlined calls.
+var dispatchFuncPtr, dispatchStored func([]float32) float32 = dispatchGeneric, nil
+
+// BenchmarkDispatchGet compares calling through Dispatch.Get on every call with an indirect
+// call through a plain function variable and through a Get result stored once.
+func BenchmarkDispatchGet(b *testing.B) {
+	x := make([]float32, 4)
+	d := NewDispatch[func([]float32) float32]("bench_sum").
+		Register("generic", 0, dispatchGeneric)
+	dispatchStored = d.Get()
+
+	b.Run("funcptr", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			dispatchFuncPtr(x)
+		}
+	})
+	b.Run("get", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			d.Get()(x)
+		}
+	})
+	b.Run("stored", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			dispatchStored(x)
+		}
+	})
+}
@@ -0,0 +1,212 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"fmt"
+	"math/bits"
+	"sort"
+)
+
+// featureMaskWords bounds the number of distinct feature names a FeatureMask can hold (64 per word).
+const featureMaskWords = 16
+
+// FeatureID identifies a feature name in the precompiled feature index.
+type FeatureID uint16
+
+// FeatureMask is a packed bitset of features, indexed by FeatureID.
+type FeatureMask [featureMaskWords]uint64
+
+// featureDesc locates one definition of a feature: a feature set and a bit in its register.
+type featureDesc struct {
+	set int // index into featureSets
+	bit uint
+}
+
+// primaryFeatureSets are consulted first when a feature name is defined in several sets,
+// because they decode the architectural feature registers directly.
+var primaryFeatureSets = []string{"StandardECX", "StandardEDX", "ExtendedEBX", "ExtendedECX", "AMDExtendedECX"}
+
+var (
+	featureSets     []FeatureSet    // cpuFeaturesList in lookup order
+	featureSetNames []string        // keys of featureSets
+	featureNames    []string        // FeatureID -> name
+	featureDescs    [][]featureDesc // FeatureID -> definitions in lookup order
+	featureIDs      map[string]FeatureID
+)
+
+func init() {
+	buildFeatureIndex()
+}
+
+// buildFeatureIndex flattens cpuFeaturesList into a name -> FeatureID table.
+// IDs are assigned in feature set order, then bit order, so they are stable for a given table.
+func buildFeatureIndex() {
+	rest := make([]string, 0, len(cpuFeaturesList))
+	for name := range cpuFeaturesList {
+		primary := false
+		for _, p := range primaryFeatureSets {
+			if p == name {
+				primary = true
+				break
+			}
+		}
+		if !primary {
+			rest = append(rest, name)
+		}
+	}
+	sort.Strings(rest)
+
+	featureSetNames = append(append([]string{}, primaryFeatureSets...), rest...)
+	featureIDs = make(map[string]FeatureID)
+	for i, name := range featureSetNames {
+		fs := cpuFeaturesList[name]
+		featureSets = append(featureSets, fs)
+
+		for _, bit := range sortedFeatureBits(fs) {
+			fname := fs.features[bit].name
+			id, ok := featureIDs[fname]
+			if !ok {
+				id = FeatureID(len(featureNames))
+				featureIDs[fname] = id
+				featureNames = append(featureNames, fname)
+				featureDescs = append(featureDescs, nil)
+				featureXState = append(featureXState, xstateRequired(fname))
+			}
+			featureDescs[id] = append(featureDescs[id], featureDesc{set: i, bit: uint(bit)})
+		}
+	}
+
+	if len(featureNames) > featureMaskWords*64 {
+		panic("cpuid: feature table exceeds FeatureMask capacity")
+	}
+}
+
+// sortedFeatureBits returns the bit positions defined in a feature set in ascending order.
+func sortedFeatureBits(fs FeatureSet) []int {
+	bitList := make([]int, 0, len(fs.features))
+	for bit := range fs.features {
+		bitList = append(bitList, bit)
+	}
+	sort.Ints(bitList)
+	return bitList
+}
+
+// LookupFeature returns the FeatureID of a feature name.
+func LookupFeature(name string) (FeatureID, bool) {
+	id, ok := featureIDs[name]
+	return id, ok
+}
+
+// Name returns the feature name of the ID.
+func (id FeatureID) Name() string {
+	if int(id) >= len(featureNames) {
+		return ""
+	}
+	return featureNames[id]
+}
+
+// FeatureMaskOf returns a mask with the named features set.
+// Resolve required feature sets once and test them with HasAll on hot paths.
+func FeatureMaskOf(names ...string) (FeatureMask, error) {
+	var m FeatureMask
+	for _, name := range names {
+		id, ok := featureIDs[name]
+		if !ok {
+			return FeatureMask{}, fmt.Errorf("unknown CPU feature %q", name)
+		}
+		m.Set(id)
+	}
+	return m, nil
+}
+
+// Set adds a feature to the mask.
+func (m *FeatureMask) Set(id FeatureID) {
+	m[id>>6] |= 1 << (id & 63)
+}
+
+// Has reports whether the feature is in the mask.
+func (m FeatureMask) Has(id FeatureID) bool {
+	return m[(id>>6)%featureMaskWords]&(1<<(id&63)) != 0
+}
+
+// HasAll reports whether every feature in required is in the mask.
+func (m FeatureMask) HasAll(required FeatureMask) bool {
+	for i := range m {
+		if required[i]&^m[i] != 0 {
+			return false
+		}
+	}
+	return true
+}
+
+// Missing returns the features of required that are not in the mask.
+func (m FeatureMask) Missing(required FeatureMask) FeatureMask {
+	var out FeatureMask
+	for i := range m {
+		out[i] = required[i] &^ m[i]
+	}
+	return out
+}
+
+// Count returns the number of features in the mask.
+func (m FeatureMask) Count() int {
+	n := 0
+	for _, w := range m {
+		n += bits.OnesCount64(w)
+	}
+	return n
+}
+
+// Names returns the feature names in the mask in FeatureID order.
+func (m FeatureMask) Names() []string {
+	names := make([]string, 0, m.Count())
+	for i, w := range m {
+		for w != 0 {
+			bit := bits.TrailingZeros64(w)
+			names = append(names, featureNames[i*64+bit])
+			w &= w - 1
+		}
+	}
+	return names
+}
+
+// GetFeatureMask returns the mask of every supported feature. It is computed once per data source
+// (the live snapshot or an offline file) and cached with it.
+func GetFeatureMask(offline bool, filename string) FeatureMask {
+	d := derivedFor(offline, filename)
+	if d == nil {
+		return FeatureMask{}
+	}
+	d.featuresOnce.Do(func() {
+		d.features = computeFeatureMask(offline, filename)
+	})
+	return d.features
+}
+
+// computeFeatureMask evaluates every feature set once and resolves each feature name
+// from its first definition whose set condition holds.
+func computeFeatureMask(offline bool, filename string) FeatureMask {
+	active := make([]bool, len(featureSets))
+	values := make([]uint32, len(featureSets))
+	for i, fs := range featureSets {
+		if fs.condition != nil && !fs.condition(offline, filename) {
+			continue
+		}
+		active[i] = true
+		values[i] = fs.registerValue(offline, filename)
+	}
+
+	var m FeatureMask
+	for id, descs := range featureDescs {
+		for _, d := range descs {
+			if !active[d.set] {
+				continue
+			}
+			if (values[d.set]>>d.bit)&1 == 1 {
+				m.Set(FeatureID(id))
+			}
+			break
+		}
+	}
+	return m
+}
@@ -45,7 +45,7 @@ func GetAllFeatureCategoriesDetailed() map[string][]map[string]string {
 	return details
 }
 
-// GetAllKnownFeatures reports all known features
+// GetAllKnownFeatures reports all known features in bit order
 func GetAllKnownFeatures(category string) []string {
 	fs, exists := cpuFeaturesList[category]
 	if !exists {
@@ -53,13 +53,13 @@ func GetAllKnownFeatures(category string) []string {
 	}
 
 	features := make([]string, 0, len(fs.features))
-	for _, f := range fs.features {
-		features = append(features, f.name)
+	for _, bit := range sortedFeatureBits(fs) {
+		features = append(features, fs.features[bit].name)
 	}
 	return features
 }
 
-// GetSupportedFeatures reports all supported features
+// GetSupportedFeatures reports all supported features in bit order
 func GetSupportedFeatures(category string, offline bool, filename string) []string {
 	fs, exists := cpuFeaturesList[category]
 	if !exists {
@@ -67,70 +67,74 @@ func GetSupportedFeatures(category string, offline bool, filename string) []stri
 	}
 
 	// If there's a condition to check (some featuresets may only be valid if condition is met)
-	if fs.condition != nil && !fs.condition(0) {
+	if fs.condition != nil && !fs.condition(offline, filename) {
 		return nil
 	}
 
-	a, b, c, d := CPUIDWithMode(fs.leaf, fs.subleaf, offline, filename)
-	var regValue uint32
-	switch fs.register {
-	case 0:
-		regValue = a
-	case 1:
-		regValue = b
-	case 2:
-		regValue = c
-	case 3:
-		regValue = d
-	}
+	regValue := fs.registerValue(offline, filename)
 
 	supported := []string{}
-	for bit, f := range fs.features {
+	for _, bit := range sortedFeatureBits(fs) {
 		if (regValue>>bit)&1 == 1 {
-			supported = append(supported, f.name)
+			supported = append(supported, fs.features[bit].name)
 		}
 	}
 	return supported
 }
 
-// IsFeatureSupported reports if a feature is supported
+// IsFeatureSupported reports if a feature is supported.
+// A name defined in several categories is resolved from the first one whose condition holds,
+// see GetFeatureMask.
 func IsFeatureSupported(featureName string, offline bool, filename string) bool {
-	for _, fs := range cpuFeaturesList {
-		// Check condition if present
-		if fs.condition != nil && !fs.condition(0) {
-			continue
-		}
+	id, ok := featureIDs[featureName]
+	if !ok {
+		return false
+	}
+	return GetFeatureMask(offline, filename).Has(id)
+}
 
-		var bitPos *int
-		for bit, f := range fs.features {
-			if f.name == featureName {
-				bitPos = &bit
-				break
-			}
-		}
+// registerValue returns the register of the feature set's leaf that holds its feature bits.
+func (fs FeatureSet) registerValue(offline bool, filename string) uint32 {
+	a, b, c, d := CPUIDWithMode(fs.leaf, fs.subleaf, offline, filename)
+	switch fs.register {
+	case 0:
+		return a
+	case 1:
+		return b
+	case 2:
+		return c
+	case 3:
+		return d
+	}
+	return 0
+}
 
-		if bitPos == nil {
-			continue // feature not in this category
-		}
+// extendedEBX returns CPUID.7.0:EBX, used by feature set conditions.
+func extendedEBX(offline bool, filename string) uint32 {
+	_, b, _, _ := CPUIDWithMode(7, 0, offline, filename)
+	return b
+}
 
-		a, b, c, d := CPUIDWithMode(fs.leaf, fs.subleaf, offline, filename)
-		var regValue uint32
-		switch fs.register {
-		case 0:
-			regValue = a
-		case 1:
-			regValue = b
-		case 2:
-			regValue = c
-		case 3:
-			regValue = d
-		}
+// FeatureRequirement is the result of checking one feature name with RequireFeatures.
+type FeatureRequirement struct {
+	Name      string
+	Known     bool // false if the name is not in the feature table
+	Supported bool
+}
 
-		if (regValue>>(*bitPos))&1 == 1 {
-			return true
-		} else {
-			return false
+// RequireFeatures checks a list of features against one data source and returns a result per name
+// (in the order given) and the names that are missing or unknown. The names are tested against
+// GetFeatureMask, which is computed once per source, so the results match IsFeatureSupported.
+func RequireFeatures(offline bool, filename string, names ...string) ([]FeatureRequirement, []string) {
+	mask := GetFeatureMask(offline, filename)
+	results := make([]FeatureRequirement, len(names))
+	missing := make([]string, 0, len(names))
+	for i, name := range names {
+		id, known := featureIDs[name]
+		results[i] = FeatureRequirement{Name: name, Known: known, Supported: known && mask.Has(id)}
+		if !results[i].Supported {
+			missing = append(missing, name)
 		}
 	}
-	return false
+	return results, missing
 }
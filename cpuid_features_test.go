@@ -0,0 +1,88 @@
+package cpuid
+
+import (
+	"path/filepath"
+	"testing"
+)
+
+// serviceFeatures is a typical startup check of a service built for x86-64-v3 with crypto.
+var serviceFeatures = []string{
+	"SSE3", "SSSE3", "SSE4_1", "SSE4_2", "POPCNT", "AVX", "AVX2", "FMA", "F16C", "BMI1", "BMI2",
+	"MOVBE", "AES", "PCLMULQDQ", "RDRAND", "RDSEED", "ADX", "SHA", "XSAVE", "OSXSAVE",
+}
+
+func TestRequireFeaturesMatchesIsFeatureSupported(t *testing.T) {
+	for _, src := range []struct {
+		offline  bool
+		filename string
+	}{{false, ""}, {true, "testdata/spr_kvm.json"}, {true, "testdata/spr_kvm.bin"}} {
+		results, missing := RequireFeatures(src.offline, src.filename, append(featureNames, "NO_SUCH_FEATURE")...)
+		nmissing := 0
+		for _, r := range results {
+			if want := IsFeatureSupported(r.Name, src.offline, src.filename); r.Supported != want {
+				t.Errorf("%q offline=%v: RequireFeatures says %v, IsFeatureSupported %v", src.filename, src.offline, r.Supported, want)
+			}
+			if !r.Supported {
+				nmissing++
+			}
+		}
+		if len(missing) != nmissing {
+			t.Errorf("%q offline=%v: %d missing names for %d unsupported results", src.filename, src.offline, len(missing), nmissing)
+		}
+	}
+}
+
+// writeDump writes entries as a JSON dump to a new file in a temporary directory.
+func writeDump(t testing.TB, entries []Entry) string {
+	t.Helper()
+	filename := filepath.Join(t.TempDir(), "cpuid_data.json")
+	if err := writeJSONFile(filename, Data{Entries: entries}); err != nil {
+		t.Fatal(err)
+	}
+	return filename
+}
+
+// intelLeaf0 is leaf 0 of an Intel CPU with leaves up to 7.
+var intelLeaf0 = Entry{Leaf: 0, EAX: 7, EBX: 0x756E6547, ECX: 0x6C65746E, EDX: 0x49656E69}
+
+func TestAMXBF16Bit(t *testing.T) {
+	for _, tc := range []struct {
+		name string
+		leaf Entry
+		want bool
+	}{
+		{"7.0:ECX[24]", Entry{Leaf: 7, ECX: 1 << 24}, false},
+		{"7.0:EDX[22]", Entry{Leaf: 7, EDX: 1 << 22}, true},
+	} {
+		filename := writeDump(t, []Entry{intelLeaf0, tc.leaf})
+		if got := IsFeatureSupported("AMX_BF16", true, filename); got != tc.want {
+			t.Errorf("only %s set: AMX_BF16 = %v, want %v", tc.name, got, tc.want)
+		}
+	}
+}
+
+// BenchmarkRequireFeatures compares one RequireFeatures call with calling IsFeatureSupported
+// for each name.
+func BenchmarkRequireFeatures(b *testing.B) {
+	for _, src := range []struct {
+		name     string
+		offline  bool
+		filename string
+	}{{"live", false, ""}, {"json", true, "testdata/spr_kvm.json"}} {
+		RequireFeatures(src.offline, src.filename, serviceFeatures...)
+		b.Run(src.name+"/RequireFeatures", func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				RequireFeatures(src.offline, src.filename, serviceFeatures...)
+			}
+		})
+		b.Run(src.name+"/IsFeatureSupported", func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				for _, name := range serviceFeatures {
+					IsFeatureSupported(name, src.offline, src.filename)
+				}
+			}
+		})
+	}
+}
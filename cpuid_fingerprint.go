@@ -0,0 +1,177 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"encoding/binary"
+	"encoding/hex"
+	"math/bits"
+)
+
+// Fingerprint identifies a CPU model together with the capabilities it reports: two captures
+// have the same fingerprint if they report the same CPUID values after per-CPU and OS-dependent
+// fields are masked. It is computed over the leaves and subleaves subleafRules enumerates,
+// reading them from the data itself, so it does not depend on which tool captured a dump or on
+// extra entries the tool recorded. Subleaves that read as all zeros are left out, as a missing
+// entry reads as zeros.
+//
+// Masked fields:
+//   - leaf 1 EBX[31:24] (initial APIC ID) and ECX[27] (OSXSAVE)
+//   - leaf 7.0 ECX[4] (OSPKE)
+//   - leaf 0xB, 0x1F and 0x80000026 EDX (x2APIC ID)
+//   - leaf 0xD.0 and 0xD.1 EBX (XSAVE size of the state components the OS enabled)
+//   - leaf 0x1A EAX (core type and native model of the CPU that ran the capture, on hybrid parts)
+//   - leaf 0x8000001E EAX (extended APIC ID), EBX[7:0] (core ID) and ECX[7:0] (node ID)
+//
+// Hybrid CPUs still differ between core types in their cache and TLB leaves.
+type Fingerprint [16]byte
+
+// String returns the fingerprint as 32 hex digits.
+func (f Fingerprint) String() string {
+	return hex.EncodeToString(f[:])
+}
+
+// Uint64 returns the first 64 bits of the fingerprint, for use as a map key or a 64-bit ID.
+func (f Fingerprint) Uint64() uint64 {
+	return binary.LittleEndian.Uint64(f[:])
+}
+
+// maxFingerprintLeaves bounds the leaves of each range walked for a fingerprint, so a corrupt
+// dump with a huge maximum leaf cannot stall it. Current CPUs use fewer than 0x30.
+const maxFingerprintLeaves = 0x100
+
+// GetFingerprint returns the fingerprint of the data source. It is computed once per source
+// (the live snapshot or an offline file) and cached with it. An unreadable file yields the
+// zero Fingerprint.
+func GetFingerprint(offline bool, filename string) Fingerprint {
+	d := derivedFor(offline, filename)
+	src := sourceFor(offline, filename)
+	if d == nil || src == nil {
+		return Fingerprint{}
+	}
+	d.fingerprintOnce.Do(func() {
+		d.fingerprint = fingerprintOf(src)
+	})
+	return d.fingerprint
+}
+
+// Fingerprint returns the fingerprint of the snapshot, computed on first use.
+func (s *Snapshot) Fingerprint() Fingerprint {
+	s.fingerprintOnce.Do(func() {
+		s.fingerprint = fingerprintOf(s)
+	})
+	return s.fingerprint
+}
+
+// Fingerprint returns the fingerprint of the dump, computed on first use.
+func (d *BinaryDump) Fingerprint() Fingerprint {
+	d.fingerprintOnce.Do(func() {
+		d.fingerprint = fingerprintOf(d)
+	})
+	return d.fingerprint
+}
+
+// fingerprintOf hashes the normalized results of a source in leaf and subleaf order.
+func fingerprintOf(src leafSource) Fingerprint {
+	get := sourceGetter(src)
+	var h fingerprintHash
+	walk := func(first, last uint32) {
+		if last-first >= maxFingerprintLeaves {
+			last = first + maxFingerprintLeaves - 1
+		}
+		for leaf := first; leaf <= last; leaf++ {
+			forEachSubleaf(leaf, get, func(subleaf, a, b, c, d uint32) bool {
+				a, b, c, d = maskPerCPU(leaf, subleaf, a, b, c, d)
+				if a|b|c|d != 0 {
+					h.write(uint64(leaf)<<32 | uint64(subleaf))
+					h.write(uint64(a)<<32 | uint64(b))
+					h.write(uint64(c)<<32 | uint64(d))
+				}
+				return true
+			})
+		}
+	}
+
+	maxStd, _, _, _ := get(0, 0)
+	walk(0, maxStd)
+	if maxStd >= 1 {
+		if _, _, c, _ := get(1, 0); c&(1<<31) != 0 {
+			maxHypervisor, _, _, _ := get(0x40000000, 0)
+			walk(0x40000000, clampHypervisorLeaf(maxHypervisor))
+		}
+	}
+	if maxExt, _, _, _ := get(0x80000000, 0); maxExt >= 0x80000000 {
+		walk(0x80000000, maxExt)
+	}
+	return h.sum()
+}
+
+// maskPerCPU clears the fields that differ between the logical CPUs of one system or depend on
+// the operating system, as listed on Fingerprint.
+func maskPerCPU(leaf, subleaf, a, b, c, d uint32) (uint32, uint32, uint32, uint32) {
+	switch leaf {
+	case 1:
+		b &^= 0xFF << 24
+		c &^= 1 << 27
+	case 7:
+		if subleaf == 0 {
+			c &^= 1 << 4
+		}
+	case 0xB, 0x1F, 0x80000026:
+		d = 0
+	case 0xD:
+		if subleaf <= 1 {
+			b = 0
+		}
+	case 0x1A:
+		a = 0
+	case 0x8000001E:
+		a = 0
+		b &^= 0xFF
+		c &^= 0xFF
+	}
+	return a, b, c, d
+}
+
+// fingerprintHash is a 128-bit hash over 64-bit words in the style of MurmurHash3 x64-128:
+// two lanes with distinct multipliers, combined and finalized with fmix64. It is fixed, unlike
+// hash/maphash, so fingerprints can be stored and compared across processes and releases.
+type fingerprintHash struct {
+	h1, h2 uint64
+	n      uint64
+}
+
+const (
+	fingerprintC1 = 0x87c37b91114253d5
+	fingerprintC2 = 0x4cf5ad432745937f
+)
+
+func (h *fingerprintHash) write(w uint64) {
+	k1 := bits.RotateLeft64(w*fingerprintC1, 31) * fingerprintC2
+	h.h1 = (bits.RotateLeft64(h.h1^k1, 27)+h.h2)*5 + 0x52dce729
+	k2 := bits.RotateLeft64(w*fingerprintC2, 33) * fingerprintC1
+	h.h2 = (bits.RotateLeft64(h.h2^k2, 31)+h.h1)*5 + 0x38495ab5
+	h.n++
+}
+
+func (h *fingerprintHash) sum() Fingerprint {
+	h1, h2 := h.h1^h.n, h.h2^h.n
+	h1 += h2
+	h2 += h1
+	h1, h2 = fmix64(h1), fmix64(h2)
+	h1 += h2
+	h2 += h1
+
+	var f Fingerprint
+	binary.LittleEndian.PutUint64(f[:], h1)
+	binary.LittleEndian.PutUint64(f[8:], h2)
+	return f
+}
+
+func fmix64(k uint64) uint64 {
+	k ^= k >> 33
+	k *= 0xff51afd7ed558ccd
+	k ^= k >> 33
+	k *= 0xc4ceb9fe1a85ec53
+	k ^= k >> 33
+	return k
+}
@@ -0,0 +1,132 @@
+package cpuid
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+// sprKVMFingerprint is the fingerprint of testdata/spr_kvm.json. It changes only if the
+// hash, the masked fields or the walked leaves change, which invalidates stored fingerprints.
+const sprKVMFingerprint = "f63328e8808a4370cca493cce0da89f1"
+
+// writeWriter16Dump writes entries in the format of writers/16bit, see writer16Dump.
+func writeWriter16Dump(t *testing.T, entries []Entry) string {
+	t.Helper()
+	var sb strings.Builder
+	sb.WriteString("{\n  \"entries\": [\n")
+	for _, e := range entries {
+		fmt.Fprintf(&sb, "    { \"leaf\": %d, \"subleaf\": %d, \"eax\": %d, \"ebx\": %d, \"ecx\": %d, \"edx\": %d },\n",
+			e.Leaf, int32(e.Subleaf), int32(e.EAX), int32(e.EBX), int32(e.ECX), int32(e.EDX))
+	}
+	sb.WriteString("  ]\n}\n")
+	filename := filepath.Join(t.TempDir(), "CPUID.JSN")
+	if err := os.WriteFile(filename, []byte(sb.String()), 0o644); err != nil {
+		t.Fatal(err)
+	}
+	return filename
+}
+
+func sprKVMEntries(t *testing.T) []Entry {
+	t.Helper()
+	data, err := DataFromFile("testdata/spr_kvm.json")
+	if err != nil {
+		t.Fatal(err)
+	}
+	return data.Entries
+}
+
+func TestFingerprintAcrossFormats(t *testing.T) {
+	want := GetFingerprint(true, "testdata/spr_kvm.json")
+	if got := want.String(); got != sprKVMFingerprint {
+		t.Errorf("fingerprint of spr_kvm.json = %s, want %s", got, sprKVMFingerprint)
+	}
+	if got := GetFingerprint(true, "testdata/spr_kvm.bin"); got != want {
+		t.Errorf("binary dump fingerprint %s, JSON %s", got, want)
+	}
+
+	if got := NewSnapshot(sprKVMEntries(t)).Fingerprint(); got != want {
+		t.Errorf("Snapshot.Fingerprint = %s, want %s", got, want)
+	}
+	dump, err := OpenBinaryDump("testdata/spr_kvm.bin")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer dump.Close()
+	if got := dump.Fingerprint(); got != want {
+		t.Errorf("BinaryDump.Fingerprint = %s, want %s", got, want)
+	}
+}
+
+// TestFingerprintMasksPerCPUFields rewrites the capture as another logical CPU with the OS
+// state disabled would report it, in the 16-bit writer format.
+func TestFingerprintMasksPerCPUFields(t *testing.T) {
+	entries := sprKVMEntries(t)
+	changed := 0
+	for i := range entries {
+		e := &entries[i]
+		switch e.Leaf {
+		case 1:
+			e.EBX ^= 0x2A << 24 // initial APIC ID
+			e.ECX &^= 1 << 27   // OSXSAVE
+			changed++
+		case 0xB, 0x1F:
+			e.EDX ^= 0x2A // x2APIC ID
+			changed++
+		}
+	}
+	if changed < 2 {
+		t.Fatalf("spr_kvm.json lacks leaves 1 and 0xB")
+	}
+
+	want := GetFingerprint(true, "testdata/spr_kvm.json")
+	if got := GetFingerprint(true, writeWriter16Dump(t, entries)); got != want {
+		t.Errorf("fingerprint of another CPU's capture = %s, want %s", got, want)
+	}
+}
+
+func TestFingerprintFeatureBit(t *testing.T) {
+	entries := sprKVMEntries(t)
+	want := NewSnapshot(entries).Fingerprint()
+	for i := range entries {
+		if entries[i].Leaf == 7 && entries[i].Subleaf == 0 {
+			entries[i].EBX ^= 1 << 16 // AVX512F
+		}
+	}
+	if got := NewSnapshot(entries).Fingerprint(); got == want {
+		t.Errorf("clearing AVX512F left the fingerprint at %s", got)
+	}
+}
+
+func TestFingerprintHash(t *testing.T) {
+	var h fingerprintHash
+	for _, w := range []uint64{0, 1, 0xFFFFFFFFFFFFFFFF, 0x0123456789ABCDEF} {
+		h.write(w)
+	}
+	if got, want := h.sum().String(), "77ee7d68d67146136630d371489eef52"; got != want {
+		t.Errorf("fingerprintHash = %s, want %s", got, want)
+	}
+}
+
+// BenchmarkFingerprint compares hashing a snapshot with reading its cached fingerprint.
+func BenchmarkFingerprint(b *testing.B) {
+	data, err := DataFromFile("testdata/spr_kvm.json")
+	if err != nil {
+		b.Fatal(err)
+	}
+	s := NewSnapshot(data.Entries)
+	b.Run("compute", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			fingerprintOf(s)
+		}
+	})
+	b.Run("cached", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			s.Fingerprint()
+		}
+	})
+}
@@ -0,0 +1,847 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"io/fs"
+	"math/bits"
+	"os"
+	"path/filepath"
+	"runtime"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+)
+
+// FleetHost is the decoded summary of one dump in a FleetIndex.
+type FleetHost struct {
+	Name       string // dump path relative to the indexed directory, without extension
+	Vendor     Vendor
+	Hypervisor Hypervisor
+	Family     uint32
+	Model      uint32
+	Stepping   uint32
+	Features   FeatureMask
+
+	ThreadsPerCore  uint32 // SMT width from the topology leaves
+	CoresPerPackage uint32 // cores the package's x2APIC ID space addresses, not the enabled count
+	LineSize        uint32
+	L1DKB           uint32 // size of one instance of each cache level, 0 if absent
+	L1IKB           uint32
+	L2KB            uint32
+	L3KB            uint32
+	TLB4KReachKB    uint32 // see Tuning.TLBReach4K
+	TLB2MReachKB    uint32
+}
+
+// Fleet index columns. Every column is a uint32 per host; the names are used in queries,
+// GroupBy and the index file.
+const (
+	fleetVendor = iota
+	fleetHypervisor
+	fleetFamily
+	fleetModel
+	fleetStepping
+	fleetThreadsPerCore
+	fleetCoresPerPackage
+	fleetLineSize
+	fleetL1D
+	fleetL1I
+	fleetL2
+	fleetL3
+	fleetTLB4KReach
+	fleetTLB2MReach
+	numFleetColumns
+)
+
+var fleetColumnNames = [numFleetColumns]string{
+	fleetVendor:          "vendor",
+	fleetHypervisor:      "hypervisor",
+	fleetFamily:          "family",
+	fleetModel:           "model",
+	fleetStepping:        "stepping",
+	fleetThreadsPerCore:  "threads_per_core",
+	fleetCoresPerPackage: "cores_per_package",
+	fleetLineSize:        "line_size",
+	fleetL1D:             "l1d_kb",
+	fleetL1I:             "l1i_kb",
+	fleetL2:              "l2_kb",
+	fleetL3:              "l3_kb",
+	fleetTLB4KReach:      "tlb_4k_reach_kb",
+	fleetTLB2MReach:      "tlb_2m_reach_kb",
+}
+
+// row returns the column values of the host.
+func (h *FleetHost) row() [numFleetColumns]uint32 {
+	return [numFleetColumns]uint32{
+		fleetVendor:          uint32(h.Vendor),
+		fleetHypervisor:      uint32(h.Hypervisor),
+		fleetFamily:          h.Family,
+		fleetModel:           h.Model,
+		fleetStepping:        h.Stepping,
+		fleetThreadsPerCore:  h.ThreadsPerCore,
+		fleetCoresPerPackage: h.CoresPerPackage,
+		fleetLineSize:        h.LineSize,
+		fleetL1D:             h.L1DKB,
+		fleetL1I:             h.L1IKB,
+		fleetL2:              h.L2KB,
+		fleetL3:              h.L3KB,
+		fleetTLB4KReach:      h.TLB4KReachKB,
+		fleetTLB2MReach:      h.TLB2MReachKB,
+	}
+}
+
+// FleetIndex is a columnar store of decoded dumps, one row per host. Feature support is kept
+// as one bitmap over the hosts per feature, so feature predicates are evaluated word by word
+// over the whole fleet. A FleetIndex is immutable and safe for concurrent use.
+type FleetIndex struct {
+	names    []string
+	columns  [numFleetColumns][]uint32
+	features [][]uint64 // FeatureID -> host bitmap, nil if no host has the feature
+}
+
+// HostSet is a set of hosts of one FleetIndex, as a bitmap over host positions.
+// Set operations return new sets and never modify their operands.
+type HostSet struct {
+	bits []uint64
+	n    int
+}
+
+func newHostSet(n int) HostSet {
+	return HostSet{bits: make([]uint64, (n+63)/64), n: n}
+}
+
+// Count returns the number of hosts in the set.
+func (s HostSet) Count() int {
+	n := 0
+	for _, w := range s.bits {
+		n += bits.OnesCount64(w)
+	}
+	return n
+}
+
+// Contains reports whether host i is in the set.
+func (s HostSet) Contains(i int) bool {
+	return i >= 0 && i < s.n && s.word(i>>6)&(1<<(i&63)) != 0
+}
+
+// Hosts returns the positions of the hosts in the set in ascending order.
+func (s HostSet) Hosts() []int {
+	hosts := make([]int, 0, s.Count())
+	for i, w := range s.bits {
+		for w != 0 {
+			hosts = append(hosts, i*64+bits.TrailingZeros64(w))
+			w &= w - 1
+		}
+	}
+	return hosts
+}
+
+// And returns the hosts in both sets.
+func (s HostSet) And(o HostSet) HostSet {
+	out := newHostSet(s.n)
+	for i := range out.bits {
+		out.bits[i] = s.word(i) & o.word(i)
+	}
+	return out
+}
+
+// Or returns the hosts in either set.
+func (s HostSet) Or(o HostSet) HostSet {
+	out := newHostSet(s.n)
+	for i := range out.bits {
+		out.bits[i] = s.word(i) | o.word(i)
+	}
+	return out
+}
+
+// AndNot returns the hosts in s that are not in o.
+func (s HostSet) AndNot(o HostSet) HostSet {
+	out := newHostSet(s.n)
+	for i := range out.bits {
+		out.bits[i] = s.word(i) &^ o.word(i)
+	}
+	return out
+}
+
+// Not returns the hosts of the index that are not in s.
+func (s HostSet) Not() HostSet {
+	out := newHostSet(s.n)
+	for i := range out.bits {
+		out.bits[i] = ^s.word(i)
+	}
+	out.trim()
+	return out
+}
+
+// word returns a word of the bitmap; a nil bitmap (a feature no host has) reads as zero.
+func (s HostSet) word(i int) uint64 {
+	if i < len(s.bits) {
+		return s.bits[i]
+	}
+	return 0
+}
+
+// trim clears the bits past the last host.
+func (s HostSet) trim() {
+	if r := s.n & 63; r != 0 {
+		s.bits[len(s.bits)-1] &= 1<<r - 1
+	}
+}
+
+// Len returns the number of hosts in the index.
+func (x *FleetIndex) Len() int {
+	return len(x.names)
+}
+
+// Name returns the name of host i.
+func (x *FleetIndex) Name(i int) string {
+	return x.names[i]
+}
+
+// Host returns the summary of host i.
+func (x *FleetIndex) Host(i int) FleetHost {
+	h := FleetHost{
+		Name:            x.names[i],
+		Vendor:          Vendor(x.columns[fleetVendor][i]),
+		Hypervisor:      Hypervisor(x.columns[fleetHypervisor][i]),
+		Family:          x.columns[fleetFamily][i],
+		Model:           x.columns[fleetModel][i],
+		Stepping:        x.columns[fleetStepping][i],
+		ThreadsPerCore:  x.columns[fleetThreadsPerCore][i],
+		CoresPerPackage: x.columns[fleetCoresPerPackage][i],
+		LineSize:        x.columns[fleetLineSize][i],
+		L1DKB:           x.columns[fleetL1D][i],
+		L1IKB:           x.columns[fleetL1I][i],
+		L2KB:            x.columns[fleetL2][i],
+		L3KB:            x.columns[fleetL3][i],
+		TLB4KReachKB:    x.columns[fleetTLB4KReach][i],
+		TLB2MReachKB:    x.columns[fleetTLB2MReach][i],
+	}
+	for id, bm := range x.features {
+		if bm != nil && bm[i>>6]&(1<<(i&63)) != 0 {
+			h.Features.Set(FeatureID(id))
+		}
+	}
+	return h
+}
+
+// All returns the set of every host in the index.
+func (x *FleetIndex) All() HostSet {
+	return HostSet{n: x.Len()}.Not()
+}
+
+// Feature returns the hosts that support the named feature.
+func (x *FleetIndex) Feature(name string) (HostSet, error) {
+	id, ok := featureIDs[name]
+	if !ok {
+		return HostSet{}, fmt.Errorf("unknown CPU feature %q", name)
+	}
+	return HostSet{bits: x.features[id], n: x.Len()}, nil
+}
+
+// FleetColumns returns the column names usable in FleetIndex queries and GroupBy.
+func FleetColumns() []string {
+	return append([]string(nil), fleetColumnNames[:]...)
+}
+
+// fleetColumn returns the index of a named column.
+func fleetColumn(name string) (int, bool) {
+	for c, n := range fleetColumnNames {
+		if n == name {
+			return c, true
+		}
+	}
+	return 0, false
+}
+
+// newFleetIndex transposes host rows into columns and feature bitmaps.
+func newFleetIndex(hosts []FleetHost) *FleetIndex {
+	n := len(hosts)
+	x := &FleetIndex{names: make([]string, n), features: make([][]uint64, len(featureNames))}
+	for c := range x.columns {
+		x.columns[c] = make([]uint32, n)
+	}
+
+	for i := range hosts {
+		h := &hosts[i]
+		x.names[i] = h.Name
+		for c, v := range h.row() {
+			x.columns[c][i] = v
+		}
+		for w, word := range h.Features {
+			for word != 0 {
+				id := w*64 + bits.TrailingZeros64(word)
+				word &= word - 1
+				if id >= len(x.features) {
+					continue
+				}
+				if x.features[id] == nil {
+					x.features[id] = make([]uint64, (n+63)/64)
+				}
+				x.features[id][i>>6] |= 1 << (i & 63)
+			}
+		}
+	}
+	return x
+}
+
+// BuildFleetIndex decodes every dump (JSON or binary) below dir with workers goroutines
+// (GOMAXPROCS if workers < 1) and indexes them, one host per file, ordered by path.
+// Files that cannot be decoded are left out; the index of the others is returned together
+// with an error listing them. Dumps are read once and not kept in the offline cache.
+func BuildFleetIndex(dir string, workers int) (*FleetIndex, error) {
+	var paths []string
+	err := filepath.WalkDir(dir, func(path string, e fs.DirEntry, err error) error {
+		if err != nil {
+			return err
+		}
+		if e.Type().IsRegular() && (strings.EqualFold(filepath.Ext(path), ".json") || IsBinaryDump(path)) {
+			paths = append(paths, path)
+		}
+		return nil
+	})
+	if err != nil {
+		return nil, err
+	}
+	sort.Strings(paths)
+
+	if workers < 1 {
+		workers = runtime.GOMAXPROCS(0)
+	}
+	hosts := make([]FleetHost, len(paths))
+	errs := make([]error, len(paths))
+	next := make(chan int)
+	var wg sync.WaitGroup
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range next {
+				hosts[i], errs[i] = decodeFleetHost(paths[i])
+				if rel, err := filepath.Rel(dir, paths[i]); err == nil {
+					hosts[i].Name = strings.TrimSuffix(rel, filepath.Ext(rel))
+				}
+			}
+		}()
+	}
+	for i := range paths {
+		next <- i
+	}
+	close(next)
+	wg.Wait()
+
+	ok := hosts[:0]
+	var failed []error
+	for i := range hosts {
+		if errs[i] != nil {
+			failed = append(failed, fmt.Errorf("%s: %w", paths[i], errs[i]))
+			continue
+		}
+		ok = append(ok, hosts[i])
+	}
+	return newFleetIndex(ok), errors.Join(failed...)
+}
+
+// decodeFleetHost decodes the summary of one dump file.
+func decodeFleetHost(filename string) (FleetHost, error) {
+	defer dropOffline(filename)
+
+	maxFunc, _, _, _, err := CPUIDWithModeErr(0, 0, true, filename)
+	if err != nil {
+		return FleetHost{}, err
+	}
+	if maxFunc == 0 {
+		return FleetHost{}, errors.New("dump holds no CPUID leaves")
+	}
+	maxExtFunc, _, _, _ := CPUIDWithMode(0x80000000, 0, true, filename)
+
+	sig := GetProcessorSignature(true, filename)
+	h := FleetHost{
+		Vendor:     GetVendor(true, filename),
+		Hypervisor: GetHypervisor(true, filename),
+		Family:     sig.Family(),
+		Model:      sig.Model(),
+		Stepping:   sig.Stepping(),
+		Features:   GetFeatureMask(true, filename),
+	}
+
+	if src := sourceFor(true, filename); src != nil {
+		shifts, _, _ := decodeTopology(src)
+		h.ThreadsPerCore = 1 << shifts[LevelCore]
+		h.CoresPerPackage = 1 << (shifts[LevelPackage] - shifts[LevelCore])
+	}
+
+	if caches, err := GetCacheInfo(maxFunc, maxExtFunc, "", true, filename); err == nil {
+		for _, c := range caches {
+			switch {
+			case c.Level == 1 && c.Type == "Instruction":
+				h.L1IKB = c.SizeKB
+			case c.Level == 1:
+				h.L1DKB, h.LineSize = c.SizeKB, c.LineSizeBytes
+			case c.Level == 2:
+				h.L2KB = c.SizeKB
+			case c.Level == 3:
+				h.L3KB = c.SizeKB
+			}
+		}
+	}
+	if t, err := GetTuning(true, filename); err == nil {
+		h.TLB4KReachKB = uint32(t.TLBReach4K >> 10)
+		h.TLB2MReachKB = uint32(t.TLBReach2M >> 10)
+	}
+	return h, nil
+}
+
+// Query returns the hosts matching a predicate expression. Terms are feature names
+// (hosts supporting the feature) or column comparisons (column op value, with op one of
+// = != < <= > >=), combined with ! (not), & (and), | (or) and parentheses; & binds tighter than |.
+// Values are numbers (decimal or 0x hex), or vendor and hypervisor names for those columns:
+//
+//	AVX512F & !AVX512_VNNI
+//	vendor=AMD & family>=0x19 & (l3_kb>=32768 | AVX512F)
+//
+// Feature terms cost one pass over the fleet's bitmap words, column comparisons one pass over
+// the column.
+func (x *FleetIndex) Query(expr string) (HostSet, error) {
+	tokens, err := lexFleetQuery(expr)
+	if err != nil {
+		return HostSet{}, err
+	}
+	p := fleetParser{x: x, tokens: tokens}
+	set, err := p.or()
+	if err != nil {
+		return HostSet{}, err
+	}
+	if p.pos < len(p.tokens) {
+		return HostSet{}, fmt.Errorf("unexpected %q in query", p.tokens[p.pos])
+	}
+	return set, nil
+}
+
+// fleetQueryOps are the operator tokens of a query, two-character ones first.
+var fleetQueryOps = []string{"!=", "<=", ">=", "=", "<", ">", "!", "&", "|", "(", ")"}
+
+// isFleetNameByte reports whether c can be part of a feature name, column name or value.
+func isFleetNameByte(c byte) bool {
+	return c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c >= '0' && c <= '9' || c == '_' || c == '.' || c == '-'
+}
+
+func lexFleetQuery(expr string) ([]string, error) {
+	var tokens []string
+	for i := 0; i < len(expr); {
+		c := expr[i]
+		if c == ' ' || c == '\t' {
+			i++
+			continue
+		}
+		if isFleetNameByte(c) {
+			j := i
+			for j < len(expr) && isFleetNameByte(expr[j]) {
+				j++
+			}
+			tokens = append(tokens, expr[i:j])
+			i = j
+			continue
+		}
+		op := ""
+		for _, o := range fleetQueryOps {
+			if strings.HasPrefix(expr[i:], o) {
+				op = o
+				break
+			}
+		}
+		if op == "" {
+			return nil, fmt.Errorf("unexpected %q in query", c)
+		}
+		tokens = append(tokens, op)
+		i += len(op)
+	}
+	return tokens, nil
+}
+
+// fleetParser evaluates a query by recursive descent while parsing it.
+type fleetParser struct {
+	x      *FleetIndex
+	tokens []string
+	pos    int
+}
+
+func (p *fleetParser) peek() string {
+	if p.pos < len(p.tokens) {
+		return p.tokens[p.pos]
+	}
+	return ""
+}
+
+func (p *fleetParser) or() (HostSet, error) {
+	set, err := p.and()
+	for err == nil && p.peek() == "|" {
+		p.pos++
+		var rhs HostSet
+		if rhs, err = p.and(); err == nil {
+			set = set.Or(rhs)
+		}
+	}
+	return set, err
+}
+
+func (p *fleetParser) and() (HostSet, error) {
+	set, err := p.unary()
+	for err == nil && p.peek() == "&" {
+		p.pos++
+		var rhs HostSet
+		if rhs, err = p.unary(); err == nil {
+			set = set.And(rhs)
+		}
+	}
+	return set, err
+}
+
+func (p *fleetParser) unary() (HostSet, error) {
+	switch tok := p.peek(); tok {
+	case "!":
+		p.pos++
+		set, err := p.unary()
+		return set.Not(), err
+	case "(":
+		p.pos++
+		set, err := p.or()
+		if err != nil {
+			return HostSet{}, err
+		}
+		if p.peek() != ")" {
+			return HostSet{}, errors.New("missing ) in query")
+		}
+		p.pos++
+		return set, nil
+	case "":
+		return HostSet{}, errors.New("incomplete query")
+	default:
+		if !isFleetNameByte(tok[0]) {
+			return HostSet{}, fmt.Errorf("unexpected %q in query", tok)
+		}
+		p.pos++
+		switch op := p.peek(); op {
+		case "=", "!=", "<", "<=", ">", ">=":
+			p.pos++
+			value := p.peek()
+			if value == "" || !isFleetNameByte(value[0]) {
+				return HostSet{}, fmt.Errorf("missing value after %s%s", tok, op)
+			}
+			p.pos++
+			return p.x.compare(tok, op, value)
+		}
+		return p.x.Feature(tok)
+	}
+}
+
+// compare returns the hosts whose column value satisfies op value.
+func (x *FleetIndex) compare(column, op, value string) (HostSet, error) {
+	c, ok := fleetColumn(column)
+	if !ok {
+		return HostSet{}, fmt.Errorf("unknown fleet column %q", column)
+	}
+	v, err := parseFleetValue(c, value)
+	if err != nil {
+		return HostSet{}, err
+	}
+
+	// Every operator selects a range [lo, hi] of values or its complement, tested with one
+	// unsigned comparison per host and packed into the bitmap a word at a time.
+	lo, hi, invert := uint32(0), ^uint32(0), false
+	switch op {
+	case "=":
+		lo, hi = v, v
+	case "!=":
+		lo, hi, invert = v, v, true
+	case "<":
+		if v == 0 {
+			return newHostSet(x.Len()), nil
+		}
+		hi = v - 1
+	case "<=":
+		hi = v
+	case ">":
+		lo, hi, invert = 0, v, true
+	case ">=":
+		lo = v
+	}
+
+	set := newHostSet(x.Len())
+	col := x.columns[c]
+	span := hi - lo
+	for w := range set.bits {
+		var word uint64
+		block := col[w*64:]
+		if len(block) > 64 {
+			block = block[:64]
+		}
+		for i, cv := range block {
+			var match uint64 // set without a branch: column values are rarely predictable
+			if cv-lo <= span {
+				match = 1
+			}
+			word |= match << i
+		}
+		set.bits[w] = word
+	}
+	if invert {
+		return set.Not(), nil
+	}
+	return set, nil
+}
+
+// parseFleetValue parses a query value for a column.
+func parseFleetValue(column int, value string) (uint32, error) {
+	if v, err := strconv.ParseUint(value, 0, 32); err == nil {
+		return uint32(v), nil
+	}
+	var names []string
+	switch column {
+	case fleetVendor:
+		names = vendorNames[:]
+	case fleetHypervisor:
+		names = hypervisorNames[:]
+	}
+	for v, name := range names {
+		if strings.EqualFold(name, value) {
+			return uint32(v), nil
+		}
+	}
+	return 0, fmt.Errorf("invalid value %q for fleet column %s", value, fleetColumnNames[column])
+}
+
+// formatFleetValue formats a column value, using names for the vendor and hypervisor.
+func formatFleetValue(column int, v uint32) string {
+	switch column {
+	case fleetVendor:
+		return Vendor(v).String()
+	case fleetHypervisor:
+		return Hypervisor(v).String()
+	}
+	return strconv.FormatUint(uint64(v), 10)
+}
+
+// FleetGroup is one row of a GroupBy result: the column values and the number of hosts having them.
+type FleetGroup struct {
+	Values []string
+	Count  int
+}
+
+// GroupBy counts the hosts of set by the values of the given columns, for histograms such as
+// L3 size by model. Groups are ordered by descending count, then by values.
+func (x *FleetIndex) GroupBy(set HostSet, columns ...string) ([]FleetGroup, error) {
+	cols := make([]int, len(columns))
+	for i, name := range columns {
+		c, ok := fleetColumn(name)
+		if !ok {
+			return nil, fmt.Errorf("unknown fleet column %q", name)
+		}
+		cols[i] = c
+	}
+
+	counts := map[string]*FleetGroup{}
+	key := make([]byte, 0, 4*len(cols))
+	for _, i := range set.Hosts() {
+		key = key[:0]
+		for _, c := range cols {
+			key = binary.LittleEndian.AppendUint32(key, x.columns[c][i])
+		}
+		g := counts[string(key)]
+		if g == nil {
+			g = &FleetGroup{Values: make([]string, len(cols))}
+			for j, c := range cols {
+				g.Values[j] = formatFleetValue(c, x.columns[c][i])
+			}
+			counts[string(key)] = g
+		}
+		g.Count++
+	}
+
+	groups := make([]FleetGroup, 0, len(counts))
+	for _, g := range counts {
+		groups = append(groups, *g)
+	}
+	sort.Slice(groups, func(i, j int) bool {
+		if groups[i].Count != groups[j].Count {
+			return groups[i].Count > groups[j].Count
+		}
+		return strings.Join(groups[i].Values, "\x00") < strings.Join(groups[j].Values, "\x00")
+	})
+	return groups, nil
+}
+
+// Fleet index file layout, all values little endian:
+//
+//	Offset 0   [8]byte  magic "CPUIDFLT"
+//	Offset 8   uint32   format version
+//	Offset 12  uint32   host count (n)
+//	Offset 16  uint32   column count
+//	Offset 20  uint32   feature count
+//	Offset 24  uint32   CRC-32C of everything after the header
+//	Offset 28  uint32   reserved, zero
+//	Offset 32  column names, feature names, then n host names, each a uint16 length and the bytes
+//	           columns: n uint32 values each, in column name order
+//	           feature bitmaps: (n+63)/64 uint64 words each, in feature name order
+//
+// Columns and features are stored by name, so an index stays readable when either list grows.
+const (
+	fleetMagic      = "CPUIDFLT"
+	fleetVersion    = 1
+	fleetHeaderSize = 32
+)
+
+// MarshalBinary encodes the index in the fleet index file format.
+func (x *FleetIndex) MarshalBinary() ([]byte, error) {
+	var features []int
+	for id, bm := range x.features {
+		if bm != nil {
+			features = append(features, id)
+		}
+	}
+
+	buf := make([]byte, fleetHeaderSize)
+	copy(buf, fleetMagic)
+	binary.LittleEndian.PutUint32(buf[8:], fleetVersion)
+	binary.LittleEndian.PutUint32(buf[12:], uint32(x.Len()))
+	binary.LittleEndian.PutUint32(buf[16:], numFleetColumns)
+	binary.LittleEndian.PutUint32(buf[20:], uint32(len(features)))
+
+	appendName := func(name string) error {
+		if len(name) > 0xFFFF {
+			return fmt.Errorf("fleet index name too long: %.40q...", name)
+		}
+		buf = binary.LittleEndian.AppendUint16(buf, uint16(len(name)))
+		buf = append(buf, name...)
+		return nil
+	}
+	for _, name := range fleetColumnNames {
+		appendName(name)
+	}
+	for _, id := range features {
+		appendName(featureNames[id])
+	}
+	for _, name := range x.names {
+		if err := appendName(name); err != nil {
+			return nil, err
+		}
+	}
+	for _, col := range x.columns {
+		for _, v := range col {
+			buf = binary.LittleEndian.AppendUint32(buf, v)
+		}
+	}
+	for _, id := range features {
+		for _, w := range x.features[id] {
+			buf = binary.LittleEndian.AppendUint64(buf, w)
+		}
+	}
+
+	binary.LittleEndian.PutUint32(buf[24:], crc32.Checksum(buf[fleetHeaderSize:], crcTable))
+	return buf, nil
+}
+
+// UnmarshalBinary decodes an index from the fleet index file format.
+// Columns and features unknown to this version of the package are skipped.
+func (x *FleetIndex) UnmarshalBinary(buf []byte) error {
+	if len(buf) < fleetHeaderSize || string(buf[:8]) != fleetMagic {
+		return errors.New("not a cpuid fleet index")
+	}
+	if v := binary.LittleEndian.Uint32(buf[8:]); v != fleetVersion {
+		return fmt.Errorf("unsupported fleet index version %d", v)
+	}
+	n := int(binary.LittleEndian.Uint32(buf[12:]))
+	numColumns := int(binary.LittleEndian.Uint32(buf[16:]))
+	numFeatures := int(binary.LittleEndian.Uint32(buf[20:]))
+	if crc32.Checksum(buf[fleetHeaderSize:], crcTable) != binary.LittleEndian.Uint32(buf[24:]) {
+		return errors.New("fleet index checksum mismatch")
+	}
+
+	r := buf[fleetHeaderSize:]
+	errShort := errors.New("fleet index truncated")
+	readNames := func(count int) ([]string, error) {
+		names := make([]string, count)
+		for i := range names {
+			if len(r) < 2 {
+				return nil, errShort
+			}
+			l := int(binary.LittleEndian.Uint16(r))
+			if len(r) < 2+l {
+				return nil, errShort
+			}
+			names[i] = string(r[2 : 2+l])
+			r = r[2+l:]
+		}
+		return names, nil
+	}
+	columnNames, err := readNames(numColumns)
+	if err != nil {
+		return err
+	}
+	features, err := readNames(numFeatures)
+	if err != nil {
+		return err
+	}
+	names, err := readNames(n)
+	if err != nil {
+		return err
+	}
+
+	words := (n + 63) / 64
+	if uint64(len(r)) != uint64(numColumns)*uint64(n)*4+uint64(numFeatures)*uint64(words)*8 {
+		return errShort
+	}
+
+	out := FleetIndex{names: names, features: make([][]uint64, len(featureNames))}
+	for c := range out.columns {
+		out.columns[c] = make([]uint32, n)
+	}
+	for _, name := range columnNames {
+		if c, ok := fleetColumn(name); ok {
+			for i := range out.columns[c] {
+				out.columns[c][i] = binary.LittleEndian.Uint32(r[4*i:])
+			}
+		}
+		r = r[4*n:]
+	}
+	for _, name := range features {
+		if id, ok := featureIDs[name]; ok {
+			bm := make([]uint64, words)
+			for i := range bm {
+				bm[i] = binary.LittleEndian.Uint64(r[8*i:])
+			}
+			out.features[id] = bm
+		}
+		r = r[8*words:]
+	}
+
+	*x = out
+	return nil
+}
+
+// WriteFile writes the index to filename, replacing it atomically.
+func (x *FleetIndex) WriteFile(filename string) error {
+	buf, err := x.MarshalBinary()
+	if err != nil {
+		return err
+	}
+	return writeFileAtomic(filename, buf)
+}
+
+// LoadFleetIndex reads an index written by WriteFile.
+func LoadFleetIndex(filename string) (*FleetIndex, error) {
+	buf, err := os.ReadFile(filename)
+	if err != nil {
+		return nil, err
+	}
+	x := &FleetIndex{}
+	if err := x.UnmarshalBinary(buf); err != nil {
+		return nil, fmt.Errorf("%s: %w", filename, err)
+	}
+	return x, nil
+}
@@ -0,0 +1,250 @@
+package cpuid
+
+import (
+	"errors"
+	"os"
+	"path/filepath"
+	"reflect"
+	"testing"
+)
+
+// fleetHost returns a host with the named features.
+func fleetHost(tb testing.TB, name string, vendor Vendor, family, model, l3KB uint32, features ...string) FleetHost {
+	tb.Helper()
+	mask, err := FeatureMaskOf(features...)
+	if err != nil {
+		tb.Fatal(err)
+	}
+	return FleetHost{Name: name, Vendor: vendor, Family: family, Model: model, L3KB: l3KB, Features: mask}
+}
+
+func testFleet(t *testing.T) *FleetIndex {
+	e := fleetHost(t, "e", VendorIntel, 6, 0x9E, 0)
+	e.Hypervisor = HypervisorKVM
+	return newFleetIndex([]FleetHost{
+		fleetHost(t, "a", VendorIntel, 6, 0x8F, 107520, "AVX2", "AVX512F", "AVX512_VNNI"),
+		fleetHost(t, "b", VendorIntel, 6, 0x55, 39424, "AVX2", "AVX512F"),
+		fleetHost(t, "c", VendorAMD, 0x19, 0x11, 32768, "AVX2", "AVX512F", "AVX512_VNNI"),
+		fleetHost(t, "d", VendorAMD, 0x17, 0x31, 16384, "AVX2"),
+		e,
+	})
+}
+
+// hostNames returns the names of the hosts in set.
+func hostNames(x *FleetIndex, set HostSet) []string {
+	names := []string{}
+	for _, i := range set.Hosts() {
+		names = append(names, x.Name(i))
+	}
+	return names
+}
+
+func TestFleetQuery(t *testing.T) {
+	x := testFleet(t)
+	for _, tc := range []struct {
+		expr string
+		want []string
+	}{
+		{"AVX512F", []string{"a", "b", "c"}},
+		{"AVX512F & !AVX512_VNNI", []string{"b"}},
+		{"!AVX512F", []string{"d", "e"}},
+		{"!!AVX512F", []string{"a", "b", "c"}},
+		{"AVX512_VNNI | AVX2 & family=0x17", []string{"a", "c", "d"}},
+		{"(AVX512_VNNI | AVX2) & family=0x17", []string{"d"}},
+		{"AMX_TILE", []string{}},
+		{"!AMX_TILE", []string{"a", "b", "c", "d", "e"}},
+		{"vendor=AMD & family>=0x19", []string{"c"}},
+		{"vendor=intel", []string{"a", "b", "e"}},
+		{"vendor!=Intel", []string{"c", "d"}},
+		{"hypervisor=KVM", []string{"e"}},
+		{"model=143", []string{"a"}},
+		{"l3_kb<0", []string{}},
+		{"l3_kb<=0", []string{"e"}},
+		{"l3_kb<32768", []string{"d", "e"}},
+		{"l3_kb>32768", []string{"a", "b"}},
+		{"l3_kb>=32768", []string{"a", "b", "c"}},
+		{"l3_kb>=0", []string{"a", "b", "c", "d", "e"}},
+		{"l3_kb>4294967295", []string{}},
+		{"l3_kb<=0xFFFFFFFF", []string{"a", "b", "c", "d", "e"}},
+		{"l3_kb!=32768", []string{"a", "b", "d", "e"}},
+	} {
+		set, err := x.Query(tc.expr)
+		if err != nil {
+			t.Errorf("Query(%q): %v", tc.expr, err)
+			continue
+		}
+		if got := hostNames(x, set); !reflect.DeepEqual(got, tc.want) {
+			t.Errorf("Query(%q) = %v, want %v", tc.expr, got, tc.want)
+		}
+	}
+
+	for _, expr := range []string{
+		"", "NO_SUCH_FEATURE", "no_such_column>=1", "family>=", "family>=abc", "vendor=Nobody",
+		"l3_kb>=4294967296", "AVX2 &", "(AVX2", "AVX2)", "AVX2 AVX512F", "AVX2 $ AVX512F", "& AVX2",
+	} {
+		if _, err := x.Query(expr); err == nil {
+			t.Errorf("Query(%q) succeeded, want an error", expr)
+		}
+	}
+}
+
+// TestFleetAbsentFeature queries a feature no host has, whose bitmap is nil.
+func TestFleetAbsentFeature(t *testing.T) {
+	x := newFleetIndex([]FleetHost{{Name: "a"}, {Name: "b"}})
+	set, err := x.Query("AVX512F")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if set.Contains(0) || set.Count() != 0 {
+		t.Errorf("Query(AVX512F) = %v, want no hosts", set.Hosts())
+	}
+	if !set.Not().Contains(1) {
+		t.Errorf("!AVX512F does not contain host 1")
+	}
+}
+
+func TestFleetGroupBy(t *testing.T) {
+	x := testFleet(t)
+	groups, err := x.GroupBy(x.All(), "vendor")
+	if err != nil {
+		t.Fatal(err)
+	}
+	want := []FleetGroup{{Values: []string{"Intel"}, Count: 3}, {Values: []string{"AMD"}, Count: 2}}
+	if !reflect.DeepEqual(groups, want) {
+		t.Errorf("GroupBy(vendor) = %v, want %v", groups, want)
+	}
+
+	// Equal counts are ordered by their values.
+	avx2, _ := x.Query("AVX2")
+	groups, err = x.GroupBy(avx2, "vendor", "family")
+	if err != nil {
+		t.Fatal(err)
+	}
+	want = []FleetGroup{
+		{Values: []string{"Intel", "6"}, Count: 2},
+		{Values: []string{"AMD", "23"}, Count: 1},
+		{Values: []string{"AMD", "25"}, Count: 1},
+	}
+	if !reflect.DeepEqual(groups, want) {
+		t.Errorf("GroupBy(vendor, family) of AVX2 = %v, want %v", groups, want)
+	}
+
+	if _, err := x.GroupBy(x.All(), "no_such_column"); err == nil {
+		t.Error("GroupBy of an unknown column succeeded")
+	}
+}
+
+func TestFleetIndexFile(t *testing.T) {
+	x := testFleet(t)
+	filename := filepath.Join(t.TempDir(), "fleet.idx")
+	if err := x.WriteFile(filename); err != nil {
+		t.Fatal(err)
+	}
+	back, err := LoadFleetIndex(filename)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !reflect.DeepEqual(back, x) {
+		t.Errorf("index changed in a round trip through %s", filename)
+	}
+	for i := 0; i < x.Len(); i++ {
+		if !reflect.DeepEqual(back.Host(i), x.Host(i)) {
+			t.Errorf("host %d = %+v, want %+v", i, back.Host(i), x.Host(i))
+		}
+	}
+
+	buf, _ := x.MarshalBinary()
+	buf[len(buf)-1] ^= 1
+	if err := new(FleetIndex).UnmarshalBinary(buf); err == nil {
+		t.Error("UnmarshalBinary accepted a corrupted index")
+	}
+	if err := new(FleetIndex).UnmarshalBinary(buf[:fleetHeaderSize-1]); err == nil {
+		t.Error("UnmarshalBinary accepted a truncated header")
+	}
+}
+
+func TestBuildFleetIndex(t *testing.T) {
+	dir := t.TempDir()
+	for _, f := range []struct{ sub, name string }{{"bin", "spr_kvm.bin"}, {"json", "spr_kvm.json"}} {
+		data, err := os.ReadFile(filepath.Join("testdata", f.name))
+		if err != nil {
+			t.Fatal(err)
+		}
+		if err := os.Mkdir(filepath.Join(dir, f.sub), 0o755); err != nil {
+			t.Fatal(err)
+		}
+		if err := os.WriteFile(filepath.Join(dir, f.sub, f.name), data, 0o644); err != nil {
+			t.Fatal(err)
+		}
+	}
+	if err := os.WriteFile(filepath.Join(dir, "broken.json"), []byte("{"), 0o644); err != nil {
+		t.Fatal(err)
+	}
+
+	x, err := BuildFleetIndex(dir, 2)
+	if err == nil {
+		t.Error("BuildFleetIndex did not report the broken dump")
+	}
+	var unwrap interface{ Unwrap() []error }
+	if !errors.As(err, &unwrap) || len(unwrap.Unwrap()) != 1 {
+		t.Errorf("BuildFleetIndex error = %v, want one failed file", err)
+	}
+	if x.Len() != 2 {
+		t.Fatalf("indexed %d hosts, want 2", x.Len())
+	}
+	a, b := x.Host(0), x.Host(1)
+	if a.Name != filepath.Join("bin", "spr_kvm") || b.Name != filepath.Join("json", "spr_kvm") {
+		t.Errorf("host names %q, %q", a.Name, b.Name)
+	}
+	a.Name, b.Name = "", ""
+	if a != b {
+		t.Errorf("binary and JSON dumps of one host decode differently:\n%+v\n%+v", a, b)
+	}
+	if a.Vendor != VendorIntel || a.L3KB == 0 || !a.Features.Has(featureIDs["AVX512F"]) {
+		t.Errorf("decoded host %+v", a)
+	}
+}
+
+// benchFleet returns a synthetic index of n hosts drawn from a few CPU models.
+func benchFleet(b *testing.B, n int) *FleetIndex {
+	models := []FleetHost{
+		fleetHost(b, "", VendorIntel, 6, 0x8F, 107520, "AVX2", "AVX512F", "AVX512_VNNI", "AMX_TILE"),
+		fleetHost(b, "", VendorIntel, 6, 0x55, 39424, "AVX2", "AVX512F"),
+		fleetHost(b, "", VendorIntel, 6, 0x9E, 12288, "AVX2"),
+		fleetHost(b, "", VendorAMD, 0x19, 0x11, 32768, "AVX2", "AVX512F", "AVX512_VNNI"),
+		fleetHost(b, "", VendorAMD, 0x19, 0x01, 262144, "AVX2"),
+		fleetHost(b, "", VendorAMD, 0x17, 0x31, 16384, "AVX2"),
+	}
+	hosts := make([]FleetHost, n)
+	seed := uint32(1)
+	for i := range hosts {
+		seed = seed*1664525 + 1013904223
+		hosts[i] = models[seed>>16%uint32(len(models))]
+	}
+	return newFleetIndex(hosts)
+}
+
+// BenchmarkFleetQuery evaluates feature, column and mixed predicates over 100k hosts.
+func BenchmarkFleetQuery(b *testing.B) {
+	x := benchFleet(b, 100000)
+	for _, q := range []struct{ name, expr string }{
+		{"feature", "AVX512F & !AVX512_VNNI"},
+		{"column", "l3_kb>=32768"},
+		{"mixed", "vendor=AMD & family>=0x19 & (l3_kb>=32768 | AVX512F)"},
+	} {
+		b.Run(q.name, func(b *testing.B) {
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				if _, err := x.Query(q.expr); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+	b.Run("groupby", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			x.GroupBy(x.All(), "model", "l3_kb")
+		}
+	})
+}
@@ -0,0 +1,190 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+// Hypervisor identifies the hypervisor from the signature in leaf 0x40000000.
+type Hypervisor uint8
+
+// Known hypervisors.
+const (
+	HypervisorNone    Hypervisor = iota // not running under a hypervisor
+	HypervisorUnknown                   // a hypervisor with an unrecognised signature
+	HypervisorKVM
+	HypervisorHyperV
+	HypervisorVMware
+	HypervisorXen
+	HypervisorQEMU // QEMU TCG (software emulation)
+	HypervisorParallels
+	HypervisorBhyve
+	HypervisorACRN
+	HypervisorQNX
+	HypervisorApple // Apple Virtualization framework
+)
+
+var hypervisorNames = [...]string{
+	HypervisorNone:      "None",
+	HypervisorUnknown:   "Unknown",
+	HypervisorKVM:       "KVM",
+	HypervisorHyperV:    "Microsoft Hyper-V",
+	HypervisorVMware:    "VMware",
+	HypervisorXen:       "Xen",
+	HypervisorQEMU:      "QEMU TCG",
+	HypervisorParallels: "Parallels",
+	HypervisorBhyve:     "bhyve",
+	HypervisorACRN:      "ACRN",
+	HypervisorQNX:       "QNX Hypervisor",
+	HypervisorApple:     "Apple Virtualization",
+}
+
+// hypervisorIDs maps the 12-byte leaf 0x40000000 signature (EBX, ECX, EDX) to a Hypervisor.
+var hypervisorIDs = map[[12]byte]Hypervisor{
+	vendorKey("KVMKVMKVM\x00\x00\x00"): HypervisorKVM,
+	vendorKey("Microsoft Hv"):          HypervisorHyperV,
+	vendorKey("VMwareVMware"):          HypervisorVMware,
+	vendorKey("XenVMMXenVMM"):          HypervisorXen,
+	vendorKey("TCGTCGTCGTCG"):          HypervisorQEMU,
+	vendorKey(" lrpepyh  vr"):          HypervisorParallels,
+	vendorKey("prl hyperv  "):          HypervisorParallels,
+	vendorKey("bhyve bhyve "):          HypervisorBhyve,
+	vendorKey("ACRNACRNACRN"):          HypervisorACRN,
+	vendorKey(" QNXQVMBSQG "):          HypervisorQNX,
+	vendorKey("VirtualApple"):          HypervisorApple,
+}
+
+// String returns the hypervisor name.
+func (h Hypervisor) String() string {
+	if int(h) < len(hypervisorNames) {
+		return hypervisorNames[h]
+	}
+	return hypervisorNames[HypervisorUnknown]
+}
+
+// HypervisorInfo describes the hypervisor leaves (0x40000000-0x400000FF).
+type HypervisorInfo struct {
+	Present   bool       // CPUID.1:ECX[31], set by hypervisors for their guests
+	Vendor    Hypervisor // decoded from Signature
+	Signature string     // 12-byte signature from 0x40000000 EBX, ECX, EDX
+	MaxLeaf   uint32     // highest hypervisor leaf, from 0x40000000 EAX
+	Interface string     // interface signature from 0x40000001 EAX, e.g. "Hv#1" for Hyper-V compatible interfaces
+
+	Features []string // supported KVMFeatures / HyperVFeatures feature names
+
+	// TSCFrequencyKHz and BusFrequencyKHz come from leaf 0x40000010 (EAX, EBX), the timing leaf
+	// defined by VMware and also provided by KVM, ACRN and others. Zero if not reported.
+	TSCFrequencyKHz uint32
+	BusFrequencyKHz uint32
+
+	InvariantTSC bool // CPUID.80000007H:EDX[8] as exposed to the guest
+	// StableTSC reports whether the TSC is safe for timing: it is invariant and, under a hypervisor,
+	// the hypervisor also vouches for it (KVM stable clocksource bit, Hyper-V invariant TSC
+	// access or a published TSC frequency).
+	StableTSC bool
+}
+
+// clampHypervisorLeaf bounds the maximum hypervisor leaf reported in 0x40000000 EAX to the
+// 0x40000000-0x400000FF range. Older KVM versions report 0, meaning 0x40000001.
+func clampHypervisorLeaf(max uint32) uint32 {
+	if max < 0x40000000 {
+		return 0x40000001
+	}
+	if max > 0x400000FF {
+		return 0x400000FF
+	}
+	return max
+}
+
+// hypervisorFrom returns the hypervisor a data source runs under, without the feature list.
+func hypervisorFrom(offline bool, filename string) (h Hypervisor, signature string, max uint32) {
+	maxStd, _, _, _ := CPUIDWithMode(0, 0, offline, filename)
+	if maxStd < 1 {
+		return HypervisorNone, "", 0
+	}
+	if _, _, c, _ := CPUIDWithMode(1, 0, offline, filename); c&(1<<31) == 0 {
+		return HypervisorNone, "", 0
+	}
+
+	a, b, c, d := CPUIDWithMode(0x40000000, 0, offline, filename)
+	var k [12]byte
+	putRegister(k[0:], b)
+	putRegister(k[4:], c)
+	putRegister(k[8:], d)
+
+	h, ok := hypervisorIDs[k]
+	if !ok {
+		h = HypervisorUnknown
+	}
+	return h, trimSignature(k[:]), clampHypervisorLeaf(a)
+}
+
+// trimSignature strips the NUL padding some hypervisors use in their signatures.
+func trimSignature(b []byte) string {
+	end := len(b)
+	for end > 0 && b[end-1] == 0 {
+		end--
+	}
+	return string(b[:end])
+}
+
+// GetHypervisor returns the hypervisor the data source runs under, or HypervisorNone on bare metal.
+func GetHypervisor(offline bool, filename string) Hypervisor {
+	h, _, _ := hypervisorFrom(offline, filename)
+	return h
+}
+
+// GetHypervisorInfo decodes the hypervisor leaves of the data source.
+func GetHypervisorInfo(offline bool, filename string) HypervisorInfo {
+	var info HypervisorInfo
+	info.Vendor, info.Signature, info.MaxLeaf = hypervisorFrom(offline, filename)
+	info.Present = info.Vendor != HypervisorNone
+
+	if maxExt, _, _, _ := CPUIDWithMode(0x80000000, 0, offline, filename); maxExt >= 0x80000007 {
+		_, _, _, d := CPUIDWithMode(0x80000007, 0, offline, filename)
+		info.InvariantTSC = d&(1<<8) != 0
+	}
+	if !info.Present {
+		info.StableTSC = info.InvariantTSC
+		return info
+	}
+
+	if info.MaxLeaf >= 0x40000001 {
+		a, _, _, _ := CPUIDWithMode(0x40000001, 0, offline, filename)
+		var sig [4]byte
+		putRegister(sig[:], a)
+		if isPrintableSignature(sig[:]) {
+			info.Interface = string(sig[:])
+		}
+	}
+	if info.MaxLeaf >= 0x40000010 {
+		info.TSCFrequencyKHz, info.BusFrequencyKHz, _, _ = CPUIDWithMode(0x40000010, 0, offline, filename)
+	}
+
+	for _, set := range []string{"KVMFeatures", "HyperVFeatures"} {
+		info.Features = append(info.Features, GetSupportedFeatures(set, offline, filename)...)
+	}
+
+	vouched := info.TSCFrequencyKHz != 0 ||
+		IsFeatureSupported("KVM_FEATURE_CLOCKSOURCE_STABLE_BIT", offline, filename) ||
+		IsFeatureSupported("HV_ACCESS_TSC_INVARIANT", offline, filename)
+	info.StableTSC = info.InvariantTSC && vouched
+	return info
+}
+
+// isPrintableSignature reports whether b is an ASCII signature rather than a bit field.
+func isPrintableSignature(b []byte) bool {
+	for _, c := range b {
+		if c < 0x20 || c > 0x7E {
+			return false
+		}
+	}
+	return true
+}
+
+// hyperVCompatible reports whether the data source exposes the Hyper-V interface
+// (Hyper-V itself, or KVM/Xen/QEMU enlightenments that emulate it).
+func hyperVCompatible(offline bool, filename string) bool {
+	h, _, max := hypervisorFrom(offline, filename)
+	if h == HypervisorNone || max < 0x40000003 {
+		return false
+	}
+	a, _, _, _ := CPUIDWithMode(0x40000001, 0, offline, filename)
+	return a == 0x31237648 // "Hv#1"
+}
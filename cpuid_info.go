@@ -2,61 +2,93 @@
 package cpuid
 
 import (
-	"fmt"
 	"strings"
 )
 
-func isAMD(offline bool, filename string) bool {
-	return strings.Contains(strings.ToUpper(GetVendorID(offline, filename)), "AMD")
-}
-
-func isIntel(offline bool, filename string) bool {
-	return strings.Contains(strings.ToUpper(GetVendorID(offline, filename)), "INTEL")
-}
-
 // GetVendorID returns the vendor ID of the CPU.
 func GetVendorID(offline bool, filename string) string {
+	id := VendorID(offline, filename)
+	return string(id[:])
+}
+
+// VendorID returns the 12-byte vendor ID of the CPU (e.g. "GenuineIntel") without allocating.
+func VendorID(offline bool, filename string) [12]byte {
+	var id [12]byte
 	_, b, c, d := CPUIDWithMode(0, 0, offline, filename)
-	return fmt.Sprintf("%s%s%s",
-		string([]byte{byte(b), byte(b >> 8), byte(b >> 16), byte(b >> 24)}),
-		string([]byte{byte(d), byte(d >> 8), byte(d >> 16), byte(d >> 24)}),
-		string([]byte{byte(c), byte(c >> 8), byte(c >> 16), byte(c >> 24)}),
-	)
+	putRegister(id[0:], b)
+	putRegister(id[4:], d)
+	putRegister(id[8:], c)
+	return id
 }
 
 // GetVendorName returns the vendor name of the CPU.
 func GetVendorName(offline bool, filename string) string {
-	vendorID := GetVendorID(offline, filename)
-	switch vendorID {
-	case "GenuineIntel":
-		return "Intel"
-	case "AuthenticAMD":
-		return "AMD"
-	default:
-		return "Unknown"
-	}
+	return GetVendor(offline, filename).String()
 }
 
 // GetBrandString returns the brand string of the CPU.
 func GetBrandString(maxExtFunc uint32, offline bool, filename string) string {
 	if maxExtFunc >= 0x80000004 {
-		var brand [48]byte
-		for i := 0; i < 3; i++ {
-			a, b, c, d := CPUIDWithMode(0x80000002+uint32(i), 0, offline, filename)
-			copy(brand[i*16:], int32ToBytes(a))
-			copy(brand[i*16+4:], int32ToBytes(b))
-			copy(brand[i*16+8:], int32ToBytes(c))
-			copy(brand[i*16+12:], int32ToBytes(d))
-		}
-		return strings.TrimSpace(string(brand[:]))
+		brand := BrandString(offline, filename)
+		return strings.Trim(string(brand[:]), " \x00")
 	}
 	return ""
 }
 
-// GetModelData contains information about the processor model.
-func GetModelData(offline bool, filename string) ProcessorModel {
-	// Get Model Data
+// BrandString returns the raw 48-byte brand string of the CPU without allocating.
+// It is NUL padded, and all zero if the CPU does not report one.
+func BrandString(offline bool, filename string) [48]byte {
+	var brand [48]byte
+	if maxExt, _, _, _ := CPUIDWithMode(0x80000000, 0, offline, filename); maxExt < 0x80000004 {
+		return brand
+	}
+	for i := 0; i < 3; i++ {
+		a, b, c, d := CPUIDWithMode(0x80000002+uint32(i), 0, offline, filename)
+		putRegister(brand[i*16:], a)
+		putRegister(brand[i*16+4:], b)
+		putRegister(brand[i*16+8:], c)
+		putRegister(brand[i*16+12:], d)
+	}
+	return brand
+}
+
+// ProcessorSignature is the packed processor signature from CPUID.1:EAX
+// (stepping, model, family, type, extended model and extended family).
+type ProcessorSignature uint32
+
+// GetProcessorSignature returns the packed processor signature without allocating.
+func GetProcessorSignature(offline bool, filename string) ProcessorSignature {
 	a, _, _, _ := CPUIDWithMode(1, 0, offline, filename)
+	return ProcessorSignature(a)
+}
+
+// Stepping returns the stepping ID.
+func (s ProcessorSignature) Stepping() uint32 {
+	return uint32(s) & 0xF
+}
+
+// Family returns the effective family (family plus extended family for family 0xF).
+func (s ProcessorSignature) Family() uint32 {
+	family := (uint32(s) >> 8) & 0xF
+	if family == 0xF {
+		family += (uint32(s) >> 20) & 0xFF
+	}
+	return family
+}
+
+// Model returns the effective model (model plus extended model for families 0x6 and 0xF).
+func (s ProcessorSignature) Model() uint32 {
+	family := (uint32(s) >> 8) & 0xF
+	model := (uint32(s) >> 4) & 0xF
+	if family == 0xF || family == 0x6 {
+		model += ((uint32(s) >> 16) & 0xF) << 4
+	}
+	return model
+}
+
+// ProcessorModel decodes the signature into its individual fields.
+func (s ProcessorSignature) ProcessorModel() ProcessorModel {
+	a := uint32(s)
 	steppingID := a & 0xF
 	modelID := (a >> 4) & 0xF
 	familyID := (a >> 8) & 0xF
@@ -64,17 +96,6 @@ func GetModelData(offline bool, filename string) ProcessorModel {
 	extendedModelID := (a >> 16) & 0xF
 	extendedFamilyID := (a >> 20) & 0xFF
 
-	// Calculate effective values
-	effectiveModel := modelID
-	if familyID == 0xF || familyID == 0x6 {
-		effectiveModel += extendedModelID << 4
-	}
-
-	effectiveFamily := familyID
-	if familyID == 0xF {
-		effectiveFamily += extendedFamilyID
-	}
-
 	return ProcessorModel{
 		steppingID,
 		modelID,
@@ -82,10 +103,14 @@ func GetModelData(offline bool, filename string) ProcessorModel {
 		processorType,
 		extendedModelID,
 		extendedFamilyID,
-		effectiveModel,
-		effectiveFamily,
+		s.Model(),
+		s.Family(),
 	}
+}
 
+// GetModelData contains information about the processor model.
+func GetModelData(offline bool, filename string) ProcessorModel {
+	return GetProcessorSignature(offline, filename).ProcessorModel()
 }
 
 // GetProcessorInfo returns detailed information about the CPU.
@@ -104,7 +129,8 @@ func GetProcessorInfo(maxFunc, maxExtFunc uint32, offline bool, filename string)
 	}
 
 	// Core and thread count detection
-	if isAMD(offline, filename) {
+	vendor := GetVendor(offline, filename)
+	if vendor.AMDCompatible() {
 		// For AMD CPUs using Extended Function 0x8000001E
 		if maxExtFunc >= 0x8000001E {
 			_, b, _, _ := CPUIDWithMode(0x8000001E, 0, offline, filename)
@@ -120,15 +146,14 @@ func GetProcessorInfo(maxFunc, maxExtFunc uint32, offline bool, filename string)
 			coreCount = ((maxLogicalProcessors + 1) / 2) // Assuming SMT is enabled
 			threadPerCore = 2                            // Most modern AMD CPUs support 2 threads per core when SMT is enabled
 		}
-	} else if isIntel(offline, filename) {
+	} else if vendor.IntelCompatible() {
 		if maxFunc >= 0xB {
 			// Use leaf 0xB for modern Intel CPUs
 			var threadsPerCore, totalLogical uint32
-			for subleaf := uint32(0); ; subleaf++ {
-				_, b, c, _ := CPUIDWithMode(0xB, subleaf, offline, filename)
+			forEachSubleaf(0xB, modeGetter(offline, filename), func(_, _, b, c, _ uint32) bool {
 				levelType := (c >> 8) & 0xFF
 				if levelType == 0 {
-					break
+					return false
 				}
 
 				levelProcessors := b & 0xFFFF
@@ -137,7 +162,8 @@ func GetProcessorInfo(maxFunc, maxExtFunc uint32, offline bool, filename string)
 				} else if levelType == 2 { // Core level
 					totalLogical = levelProcessors
 				}
-			}
+				return true
+			})
 
 			if totalLogical > 0 && threadsPerCore > 0 {
 				coreCount = totalLogical / threadsPerCore
@@ -0,0 +1,44 @@
+package cpuid
+
+import (
+	"runtime"
+	"testing"
+)
+
+func TestIdentityGettersDoNotAllocate(t *testing.T) {
+	sources := []struct {
+		name     string
+		offline  bool
+		filename string
+	}{
+		{"live", false, ""},
+		{"json", true, "testdata/spr_kvm.json"},
+		{"binary", true, "testdata/spr_kvm.bin"},
+	}
+	getters := []struct {
+		name string
+		fn   func(offline bool, filename string)
+	}{
+		{"VendorID", func(offline bool, filename string) { VendorID(offline, filename) }},
+		{"BrandString", func(offline bool, filename string) { BrandString(offline, filename) }},
+		{"GetProcessorSignature", func(offline bool, filename string) { GetProcessorSignature(offline, filename) }},
+	}
+
+	for _, src := range sources {
+		if src.offline {
+			// Revalidating a loaded dump needs an allocation-free stat, see statStamp.
+			if runtime.GOOS != "linux" || runtime.GOARCH != "amd64" && runtime.GOARCH != "arm64" {
+				continue
+			}
+			if _, err := LoadSnapshot(src.filename); err != nil {
+				t.Fatal(err)
+			}
+		}
+		for _, g := range getters {
+			allocs := testing.AllocsPerRun(100, func() { g.fn(src.offline, src.filename) })
+			if allocs != 0 {
+				t.Errorf("%s/%s: %v allocations per call, want 0", g.name, src.name, allocs)
+			}
+		}
+	}
+}
@@ -0,0 +1,508 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"bytes"
+	"errors"
+	"fmt"
+	"unicode/utf16"
+	"unicode/utf8"
+)
+
+// maxJSONDepth bounds the nesting of values skipped by the dump parser, as encoding/json does.
+const maxJSONDepth = 10000
+
+// dumpParser decodes the JSON dump schema without reflection:
+//
+//	{"entries": [{"leaf": 0, "subleaf": 0, "eax": 0, "ebx": 0, "ecx": 0, "edx": 0}, ...],
+//	 "per_cpu": [{"cpu": 0, "entries": [...]}, ...]}
+//
+// It follows encoding/json for this schema (keys match case-insensitively, unknown keys are
+// skipped, null leaves a field unset, the first value ends the input), with two extensions for
+// the writers: trailing commas in objects and arrays are accepted, and negative register values,
+// which the 16-bit writers print with %ld, are read as their 32-bit two's complement.
+// Entries are parsed into one preallocated arena that the returned slices share.
+type dumpParser struct {
+	buf   []byte
+	pos   int
+	arena []Entry
+	key   []byte // scratch for keys with escapes
+}
+
+var (
+	keyEntries = []byte("entries")
+	keyPerCPU  = []byte("per_cpu")
+	keyCPU     = []byte("cpu")
+	entryKeys  = [...][]byte{[]byte("leaf"), []byte("subleaf"), []byte("eax"), []byte("ebx"), []byte("ecx"), []byte("edx")}
+)
+
+// parseDataJSON decodes a JSON dump.
+func parseDataJSON(buf []byte) (Data, error) {
+	// Every entry is an object, so the number of braces bounds the number of entries.
+	p := dumpParser{buf: buf, arena: make([]Entry, 0, bytes.Count(buf, []byte{'{'}))}
+
+	var data Data
+	p.skipSpace()
+	if p.pos == len(p.buf) {
+		return Data{}, errors.New("unexpected end of JSON input")
+	}
+	if p.literal("null") {
+		return data, nil
+	}
+	err := p.object(func(key []byte) error {
+		switch {
+		case bytes.EqualFold(key, keyEntries):
+			entries, err := p.entries(data.Entries)
+			data.Entries = entries
+			return err
+		case bytes.EqualFold(key, keyPerCPU):
+			return p.perCPU(&data.PerCPU)
+		}
+		return p.skipValue(1)
+	})
+	if err != nil {
+		return Data{}, err
+	}
+	return data, nil
+}
+
+// syntaxError reports an unexpected byte or the end of the input at the current position.
+func (p *dumpParser) syntaxError(context string) error {
+	if p.pos >= len(p.buf) {
+		return errors.New("unexpected end of JSON input")
+	}
+	return fmt.Errorf("invalid character %q %s at offset %d", p.buf[p.pos], context, p.pos)
+}
+
+var jsonSpace = [256]bool{' ': true, '\t': true, '\n': true, '\r': true}
+
+// skipSpace skips whitespace, which is most of the bytes of an indented dump.
+func (p *dumpParser) skipSpace() {
+	buf, i := p.buf, p.pos
+	for i < len(buf) && jsonSpace[buf[i]] {
+		i++
+	}
+	p.pos = i
+}
+
+// literal consumes lit if the input continues with it.
+func (p *dumpParser) literal(lit string) bool {
+	if len(p.buf)-p.pos >= len(lit) && string(p.buf[p.pos:p.pos+len(lit)]) == lit {
+		p.pos += len(lit)
+		return true
+	}
+	return false
+}
+
+// object parses an object, calling member with each key positioned at its value.
+func (p *dumpParser) object(member func(key []byte) error) error {
+	p.skipSpace()
+	if p.pos >= len(p.buf) || p.buf[p.pos] != '{' {
+		return p.syntaxError("looking for beginning of object")
+	}
+	p.pos++
+	for {
+		p.skipSpace()
+		if p.pos < len(p.buf) && p.buf[p.pos] == '}' {
+			p.pos++
+			return nil
+		}
+		key, err := p.objectKey()
+		if err != nil {
+			return err
+		}
+		p.skipSpace()
+		if p.pos >= len(p.buf) || p.buf[p.pos] != ':' {
+			return p.syntaxError("after object key")
+		}
+		p.pos++
+		p.skipSpace()
+		if err := member(key); err != nil {
+			return err
+		}
+		p.skipSpace()
+		if p.pos < len(p.buf) && p.buf[p.pos] == ',' {
+			p.pos++
+			continue
+		}
+		if p.pos < len(p.buf) && p.buf[p.pos] == '}' {
+			p.pos++
+			return nil
+		}
+		return p.syntaxError("after object key:value pair")
+	}
+}
+
+// array parses an array, calling elem positioned at each element.
+func (p *dumpParser) array(elem func() error) error {
+	if p.pos >= len(p.buf) || p.buf[p.pos] != '[' {
+		return p.syntaxError("looking for beginning of array")
+	}
+	p.pos++
+	for {
+		p.skipSpace()
+		if p.pos < len(p.buf) && p.buf[p.pos] == ']' {
+			p.pos++
+			return nil
+		}
+		if err := elem(); err != nil {
+			return err
+		}
+		p.skipSpace()
+		if p.pos < len(p.buf) && p.buf[p.pos] == ',' {
+			p.pos++
+			continue
+		}
+		if p.pos < len(p.buf) && p.buf[p.pos] == ']' {
+			p.pos++
+			return nil
+		}
+		return p.syntaxError("after array element")
+	}
+}
+
+// entries parses an array of entries into the arena. null yields a nil slice. Like encoding/json,
+// a repeated key decodes into the entries of the previous value: prev[i] is the starting value
+// of element i, which fields that are absent or null leave unchanged.
+func (p *dumpParser) entries(prev []Entry) ([]Entry, error) {
+	if p.literal("null") {
+		return nil, nil
+	}
+	start := len(p.arena)
+	err := p.array(func() error {
+		var e Entry
+		if i := len(p.arena) - start; i < len(prev) {
+			e = prev[i]
+		}
+		p.arena = append(p.arena, e)
+		if p.literal("null") {
+			return nil
+		}
+		ep := &p.arena[len(p.arena)-1]
+		return p.object(func(key []byte) error {
+			switch string(key) { // exact keys first, as every writer spells them
+			case "leaf":
+				return p.register(&ep.Leaf)
+			case "subleaf":
+				return p.register(&ep.Subleaf)
+			case "eax":
+				return p.register(&ep.EAX)
+			case "ebx":
+				return p.register(&ep.EBX)
+			case "ecx":
+				return p.register(&ep.ECX)
+			case "edx":
+				return p.register(&ep.EDX)
+			}
+			fields := [...]*uint32{&ep.Leaf, &ep.Subleaf, &ep.EAX, &ep.EBX, &ep.ECX, &ep.EDX}
+			for i, k := range entryKeys {
+				if bytes.EqualFold(key, k) {
+					return p.register(fields[i])
+				}
+			}
+			return p.skipValue(3)
+		})
+	})
+	if err != nil {
+		return nil, err
+	}
+	// Cap the slice so that appending to it cannot overwrite the entries parsed after it.
+	return p.arena[start:len(p.arena):len(p.arena)], nil
+}
+
+// perCPU parses the per_cpu array into out, starting from its previous elements like entries.
+func (p *dumpParser) perCPU(out *[]CPUData) error {
+	if p.literal("null") {
+		*out = nil
+		return nil
+	}
+	prev := *out
+	var cpus []CPUData
+	err := p.array(func() error {
+		var c CPUData
+		if len(cpus) < len(prev) {
+			c = prev[len(cpus)]
+		}
+		if p.literal("null") {
+			cpus = append(cpus, c)
+			return nil
+		}
+		err := p.object(func(key []byte) error {
+			switch {
+			case bytes.EqualFold(key, keyCPU):
+				if p.literal("null") {
+					return nil
+				}
+				v, neg, err := p.integer()
+				if err != nil {
+					return err
+				}
+				if v > uint64(maxInt) {
+					return fmt.Errorf("cpu number out of range at offset %d", p.pos)
+				}
+				c.CPU = int(v)
+				if neg {
+					c.CPU = -c.CPU
+				}
+				return nil
+			case bytes.EqualFold(key, keyEntries):
+				entries, err := p.entries(c.Entries)
+				c.Entries = entries
+				return err
+			}
+			return p.skipValue(3)
+		})
+		cpus = append(cpus, c)
+		return err
+	})
+	if err != nil {
+		return err
+	}
+	if cpus == nil {
+		cpus = []CPUData{}
+	}
+	*out = cpus
+	return nil
+}
+
+const maxInt = int(^uint(0) >> 1)
+
+// register parses a register value into dst. Negative values down to -2^31 are stored as their
+// 32-bit two's complement; null leaves dst unchanged.
+func (p *dumpParser) register(dst *uint32) error {
+	if p.literal("null") {
+		return nil
+	}
+	v, neg, err := p.integer()
+	if err != nil {
+		return err
+	}
+	switch {
+	case !neg && v <= 0xFFFFFFFF:
+		*dst = uint32(v)
+	case neg && v <= 1<<31:
+		*dst = uint32(-int64(v))
+	default:
+		return fmt.Errorf("register value out of range at offset %d", p.pos)
+	}
+	return nil
+}
+
+// integer parses a JSON number that must be an integer, returning its magnitude and sign.
+func (p *dumpParser) integer() (v uint64, neg bool, err error) {
+	start := p.pos
+	if p.pos < len(p.buf) && p.buf[p.pos] == '-' {
+		neg = true
+		p.pos++
+	}
+	digits := p.pos
+	if p.pos >= len(p.buf) || p.buf[p.pos] < '0' || p.buf[p.pos] > '9' {
+		return 0, false, p.syntaxError("in numeric literal")
+	}
+	if p.buf[p.pos] == '0' {
+		p.pos++
+	} else {
+		for p.pos < len(p.buf) && p.buf[p.pos] >= '0' && p.buf[p.pos] <= '9' {
+			if v > (1<<63)/10 {
+				return 0, false, fmt.Errorf("number %s out of range", p.buf[start:p.pos])
+			}
+			v = v*10 + uint64(p.buf[p.pos]-'0')
+			p.pos++
+		}
+	}
+	if p.pos < len(p.buf) && (p.buf[p.pos] == '.' || p.buf[p.pos] == 'e' || p.buf[p.pos] == 'E') {
+		p.pos = digits
+		if err := p.skipNumber(); err != nil {
+			return 0, false, err
+		}
+		return 0, false, fmt.Errorf("cannot use number %s as an integer", p.buf[start:p.pos])
+	}
+	return v, neg, nil
+}
+
+// skipNumber consumes a JSON number without a sign.
+func (p *dumpParser) skipNumber() error {
+	digits := func() int {
+		n := 0
+		for p.pos < len(p.buf) && p.buf[p.pos] >= '0' && p.buf[p.pos] <= '9' {
+			p.pos++
+			n++
+		}
+		return n
+	}
+
+	if p.pos < len(p.buf) && p.buf[p.pos] == '0' {
+		p.pos++
+	} else if digits() == 0 {
+		return p.syntaxError("in numeric literal")
+	}
+	if p.pos < len(p.buf) && p.buf[p.pos] == '.' {
+		p.pos++
+		if digits() == 0 {
+			return p.syntaxError("after decimal point in numeric literal")
+		}
+	}
+	if p.pos < len(p.buf) && (p.buf[p.pos] == 'e' || p.buf[p.pos] == 'E') {
+		p.pos++
+		if p.pos < len(p.buf) && (p.buf[p.pos] == '+' || p.buf[p.pos] == '-') {
+			p.pos++
+		}
+		if digits() == 0 {
+			return p.syntaxError("in exponent of numeric literal")
+		}
+	}
+	return nil
+}
+
+// objectKey parses a string and returns its decoded bytes, which are only valid until the next key.
+func (p *dumpParser) objectKey() ([]byte, error) {
+	if p.pos >= len(p.buf) || p.buf[p.pos] != '"' {
+		return nil, p.syntaxError("looking for beginning of object key string")
+	}
+	start := p.pos + 1
+	escaped, err := p.skipString()
+	if err != nil {
+		return nil, err
+	}
+	raw := p.buf[start : p.pos-1]
+	if !escaped {
+		return raw, nil
+	}
+	p.key = unescapeJSON(p.key[:0], raw)
+	return p.key, nil
+}
+
+// skipString consumes a string, validating its escapes, and reports whether it had any.
+func (p *dumpParser) skipString() (escaped bool, err error) {
+	p.pos++ // opening quote
+	for p.pos < len(p.buf) {
+		// Plain bytes are consumed in a tight loop; quotes, escapes and control bytes end it.
+		i := p.pos
+		for i < len(p.buf) && p.buf[i] != '"' && p.buf[i] != '\\' && p.buf[i] >= 0x20 {
+			i++
+		}
+		p.pos = i
+		if i == len(p.buf) {
+			break
+		}
+		c := p.buf[i]
+		switch {
+		case c == '"':
+			p.pos++
+			return escaped, nil
+		case c < 0x20:
+			return false, p.syntaxError("in string literal")
+		case c == '\\':
+			escaped = true
+			p.pos++
+			if p.pos >= len(p.buf) {
+				return false, p.syntaxError("in string escape code")
+			}
+			switch p.buf[p.pos] {
+			case '"', '\\', '/', 'b', 'f', 'n', 'r', 't':
+				p.pos++
+			case 'u':
+				p.pos++
+				for i := 0; i < 4; i++ {
+					if p.pos >= len(p.buf) || unhex(p.buf[p.pos]) < 0 {
+						return false, p.syntaxError("in \\u hexadecimal character escape")
+					}
+					p.pos++
+				}
+			default:
+				return false, p.syntaxError("in string escape code")
+			}
+		default:
+			p.pos++
+		}
+	}
+	return false, p.syntaxError("in string literal")
+}
+
+// skipValue consumes any JSON value, allowing trailing commas like the dump parser does.
+func (p *dumpParser) skipValue(depth int) error {
+	if depth > maxJSONDepth {
+		return errors.New("exceeded max depth")
+	}
+	p.skipSpace()
+	if p.pos >= len(p.buf) {
+		return p.syntaxError("looking for beginning of value")
+	}
+	switch c := p.buf[p.pos]; {
+	case c == '{':
+		return p.object(func([]byte) error { return p.skipValue(depth + 1) })
+	case c == '[':
+		return p.array(func() error { return p.skipValue(depth + 1) })
+	case c == '"':
+		_, err := p.skipString()
+		return err
+	case c == '-':
+		p.pos++
+		return p.skipNumber()
+	case c >= '0' && c <= '9':
+		return p.skipNumber()
+	case p.literal("true"), p.literal("false"), p.literal("null"):
+		return nil
+	}
+	return p.syntaxError("looking for beginning of value")
+}
+
+func unhex(c byte) rune {
+	switch {
+	case c >= '0' && c <= '9':
+		return rune(c - '0')
+	case c >= 'a' && c <= 'f':
+		return rune(c - 'a' + 10)
+	case c >= 'A' && c <= 'F':
+		return rune(c - 'A' + 10)
+	}
+	return -1
+}
+
+// unescapeJSON appends the decoded contents of a validated string literal (without quotes) to dst.
+// Invalid surrogates decode to U+FFFD, as in encoding/json.
+func unescapeJSON(dst, s []byte) []byte {
+	hex4 := func(i int) rune {
+		return unhex(s[i])<<12 | unhex(s[i+1])<<8 | unhex(s[i+2])<<4 | unhex(s[i+3])
+	}
+	for i := 0; i < len(s); {
+		if s[i] != '\\' {
+			dst = append(dst, s[i])
+			i++
+			continue
+		}
+		switch s[i+1] {
+		case 'b':
+			dst = append(dst, '\b')
+		case 'f':
+			dst = append(dst, '\f')
+		case 'n':
+			dst = append(dst, '\n')
+		case 'r':
+			dst = append(dst, '\r')
+		case 't':
+			dst = append(dst, '\t')
+		case 'u':
+			r := hex4(i + 2)
+			i += 6
+			if utf16.IsSurrogate(r) {
+				if i+6 <= len(s) && s[i] == '\\' && s[i+1] == 'u' {
+					if r2 := utf16.DecodeRune(r, hex4(i+2)); r2 != utf8.RuneError {
+						r = r2
+						i += 6
+					} else {
+						r = utf8.RuneError
+					}
+				} else {
+					r = utf8.RuneError
+				}
+			}
+			dst = utf8.AppendRune(dst, r)
+			continue
+		default: // '"', '\\', '/'
+			dst = append(dst, s[i+1])
+		}
+		i += 2
+	}
+	return dst
+}
@@ -0,0 +1,99 @@
+package cpuid
+
+import (
+	"encoding/json"
+	"os"
+	"reflect"
+	"testing"
+)
+
+// writer16Dump is the output format of writers/16bit: registers printed with %ld, so values
+// with the top bit set are negative, and a comma after every entry including the last.
+const writer16Dump = `{
+  "entries": [
+    { "leaf": 0, "subleaf": 0, "eax": 13, "ebx": 1970169159, "ecx": 1818588270, "edx": 1231384169 },
+    { "leaf": 1, "subleaf": 0, "eax": 198339, "ebx": 2048, "ecx": -98698253, "edx": -1075053569 },
+  ]
+}
+`
+
+func TestParseDataJSONWriter16(t *testing.T) {
+	data, err := parseDataJSON([]byte(writer16Dump))
+	if err != nil {
+		t.Fatal(err)
+	}
+	want := []Entry{
+		{Leaf: 0, EAX: 13, EBX: 0x756E6547, ECX: 0x6C65746E, EDX: 0x49656E69},
+		{Leaf: 1, EAX: 0x306C3, EBX: 0x800, ECX: 0xFA1DFBF3, EDX: 0xBFEBFBFF},
+	}
+	if !reflect.DeepEqual(data.Entries, want) {
+		t.Errorf("entries = %+v, want %+v", data.Entries, want)
+	}
+}
+
+// FuzzParseDataJSON checks the dump parser against encoding/json: whatever encoding/json
+// decodes into Data, the parser must decode to the same value. The parser may accept more,
+// the trailing commas and negative registers of the writers.
+func FuzzParseDataJSON(f *testing.F) {
+	dump, err := os.ReadFile("testdata/spr_kvm.json")
+	if err != nil {
+		f.Fatal(err)
+	}
+	f.Add(dump)
+	f.Add([]byte(writer16Dump))
+	for _, seed := range []string{
+		`null`,
+		`{}`,
+		`{"entries": null, "per_cpu": []}`,
+		`{"Entries": [{"LEAF": 7, "subLeaf": 1, "eax": 4294967295}], "other": {"a": [1, 2.5e3, "x"]}}`,
+		`{"entries": [{"leaf": 1, "eax": 2}], "entries": [{"ebx": 3}, null]}`,
+		`{"per_cpu": [{"cpu": 3, "entries": [{"leaf": 4, "subleaf": 2}]}, null], "per_cpu": [{"cpu": null}]}`,
+		`{"entries": [{"leaf": 1, "\ud800": 2}], "eſtries": []}`,
+		`{"entries": [{"leaf": 1.0}]}`,
+		`{"entries": [{"leaf": -1}]}`,
+		`{"entries": [{"leaf": 4294967296}]}`,
+		`{"entries": [], }`,
+	} {
+		f.Add([]byte(seed))
+	}
+
+	f.Fuzz(func(t *testing.T, buf []byte) {
+		got, err := parseDataJSON(buf)
+
+		var want Data
+		if json.Unmarshal(buf, &want) != nil {
+			return
+		}
+		if err != nil {
+			t.Fatalf("parseDataJSON failed where encoding/json succeeded: %v", err)
+		}
+		if !reflect.DeepEqual(got, want) {
+			t.Fatalf("parseDataJSON = %+v, encoding/json = %+v", got, want)
+		}
+	})
+}
+
+// BenchmarkDataFromFile compares DataFromFile with decoding the same dump with encoding/json.
+func BenchmarkDataFromFile(b *testing.B) {
+	b.Run("parser", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			if _, err := DataFromFile("testdata/spr_kvm.json"); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+	b.Run("encoding-json", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			buf, err := os.ReadFile("testdata/spr_kvm.json")
+			if err != nil {
+				b.Fatal(err)
+			}
+			var data Data
+			if err := json.Unmarshal(buf, &data); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
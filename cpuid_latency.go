@@ -0,0 +1,186 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"errors"
+	"math/rand"
+	"sort"
+	"time"
+	"unsafe"
+)
+
+// LatencyPoint is the load-to-use latency measured for one working-set size.
+type LatencyPoint struct {
+	Bytes  uint64  `json:"bytes"`
+	Nanos  float64 `json:"ns"`
+	Cycles float64 `json:"cycles"` // TSC cycles, which tick at the nominal frequency
+}
+
+// LatencyLevel compares one cache level reported by GetCacheInfo with the latency plateau
+// measured for it.
+type LatencyLevel struct {
+	Level         uint32  `json:"level"`
+	ReportedBytes uint64  `json:"reported_bytes"` // per instance, from CPUID
+	MeasuredBytes uint64  `json:"measured_bytes"` // largest working set on the level's plateau, 0 if none was found
+	Nanos         float64 `json:"ns"`             // median latency of the plateau
+	Cycles        float64 `json:"cycles"`
+	Match         bool    `json:"match"` // measured size within a factor of two of the reported size
+}
+
+// LatencyProfile is the result of ProbeLatency.
+type LatencyProfile struct {
+	CPU          int            `json:"cpu"`        // CPU the probe ran on, -1 if the thread could not be pinned
+	HugePages    bool           `json:"huge_pages"` // the buffer was advised to use transparent huge pages
+	Points       []LatencyPoint `json:"points"`
+	Levels       []LatencyLevel `json:"levels"`
+	MemoryNanos  float64        `json:"memory_ns"` // plateau beyond the last cache, 0 if the sweep did not reach it
+	MemoryCycles float64        `json:"memory_cycles"`
+}
+
+const (
+	probeMinBytes = 4 << 10
+	probeLine     = 64
+	probeLoads    = 1 << 20 // minimum dependent loads timed per working set
+	plateauJump   = 1.3     // latency ratio between neighbouring points that starts a new plateau
+)
+
+var probeSink uint32
+
+// ProbeLatency measures load latency with a pointer chase over working sets from 4KB to
+// maxBytes, on a thread pinned to one CPU. Each working set is a random cyclic permutation of
+// its cache lines, so hardware prefetchers cannot follow it. The latency curve is split into
+// plateaus, which are matched in order to the data and unified caches of GetCacheInfo; the
+// plateau after the last cache is memory. On VMs whose CPUID reports host cache sizes or
+// sharing, measured and reported sizes disagree.
+func ProbeLatency(maxBytes uint64) (LatencyProfile, error) {
+	if maxBytes < probeMinBytes {
+		return LatencyProfile{}, errors.New("maximum working set must be at least 4KB")
+	}
+
+	cpu, restore, err := pinThread()
+	if err != nil {
+		return LatencyProfile{}, err
+	}
+	defer restore()
+
+	buf, huge, free, err := allocProbeBuffer(int(maxBytes))
+	if err != nil {
+		return LatencyProfile{}, err
+	}
+	defer free()
+
+	p := LatencyProfile{CPU: cpu, HugePages: huge}
+	words := unsafe.Slice((*uint32)(unsafe.Pointer(&buf[0])), len(buf)/4)
+	rng := rand.New(rand.NewSource(1))
+	for _, size := range probeSizes(maxBytes) {
+		p.Points = append(p.Points, chaseLatency(words, size, rng))
+	}
+
+	maxFunc, maxExtFunc := GetMaxFunctions(false, "")
+	caches, _ := GetCacheInfo(maxFunc, maxExtFunc, "", false, "")
+	p.Levels, p.MemoryNanos, p.MemoryCycles = matchPlateaus(p.Points, caches)
+	return p, nil
+}
+
+// probeSizes returns the working sets of the sweep: powers of two and the midpoints 1.5x above them.
+func probeSizes(maxBytes uint64) []uint64 {
+	var sizes []uint64
+	for s := uint64(probeMinBytes); s <= maxBytes; s *= 2 {
+		sizes = append(sizes, s)
+		if m := s + s/2; m <= maxBytes {
+			sizes = append(sizes, m)
+		}
+	}
+	return sizes
+}
+
+// chaseLatency links the first size bytes of words into a ring with one element per cache line,
+// visited in random order, and times dependent loads around it.
+func chaseLatency(words []uint32, size uint64, rng *rand.Rand) LatencyPoint {
+	const stride = probeLine / 4
+	lines := int(size / probeLine)
+	order := rng.Perm(lines)
+	for i, line := range order {
+		words[line*stride] = uint32(order[(i+1)%lines] * stride)
+	}
+
+	loads := probeLoads
+	if n := 4 * lines; n > loads {
+		loads = n
+	}
+
+	// Warm up one lap, then time the chase.
+	next := uint32(0)
+	for i := 0; i < lines; i++ {
+		next = words[next]
+	}
+	start := time.Now()
+	lo, hi := rdtsc()
+	for i := 0; i < loads; i++ {
+		next = words[next]
+	}
+	lo2, hi2 := rdtsc()
+	elapsed := time.Since(start)
+	probeSink = next
+
+	cycles := (uint64(hi2)<<32 | uint64(lo2)) - (uint64(hi)<<32 | uint64(lo))
+	return LatencyPoint{
+		Bytes:  size,
+		Nanos:  float64(elapsed.Nanoseconds()) / float64(loads),
+		Cycles: float64(cycles) / float64(loads),
+	}
+}
+
+// matchPlateaus splits the latency curve into plateaus and assigns them in order to the data and
+// unified caches; the first plateau after the caches is memory. A new plateau starts where the
+// latency rises by plateauJump over the previous point and the next point confirms the rise;
+// plateaus of a single point are transitions and dropped.
+func matchPlateaus(points []LatencyPoint, caches []CPUCacheInfo) (levels []LatencyLevel, memNanos, memCycles float64) {
+	var plateaus [][]LatencyPoint
+	var cur []LatencyPoint
+	for i, pt := range points {
+		if i > 0 {
+			threshold := points[i-1].Nanos * plateauJump
+			if pt.Nanos > threshold && (i+1 == len(points) || points[i+1].Nanos > threshold) {
+				if len(cur) >= 2 {
+					plateaus = append(plateaus, cur)
+				}
+				cur = nil
+			}
+		}
+		cur = append(cur, pt)
+	}
+	if len(cur) >= 2 {
+		plateaus = append(plateaus, cur)
+	}
+
+	for _, c := range caches {
+		if c.Type == "Instruction" {
+			continue
+		}
+		l := LatencyLevel{Level: c.Level, ReportedBytes: uint64(c.SizeKB) * 1024}
+		if len(plateaus) > 0 {
+			pl := plateaus[0]
+			plateaus = plateaus[1:]
+			l.MeasuredBytes = pl[len(pl)-1].Bytes
+			l.Nanos, l.Cycles = plateauMedian(pl)
+			l.Match = l.MeasuredBytes*2 >= l.ReportedBytes && l.MeasuredBytes <= l.ReportedBytes*2
+		}
+		levels = append(levels, l)
+	}
+	if len(plateaus) > 0 {
+		memNanos, memCycles = plateauMedian(plateaus[0])
+	}
+	return levels, memNanos, memCycles
+}
+
+func plateauMedian(pl []LatencyPoint) (nanos, cycles float64) {
+	ns := make([]float64, len(pl))
+	cy := make([]float64, len(pl))
+	for i, pt := range pl {
+		ns[i], cy[i] = pt.Nanos, pt.Cycles
+	}
+	sort.Float64s(ns)
+	sort.Float64s(cy)
+	return ns[len(ns)/2], cy[len(cy)/2]
+}
@@ -0,0 +1,27 @@
+//go:build linux
+// +build linux
+
+package cpuid
+
+import (
+	"syscall"
+	"unsafe"
+)
+
+// allocProbeBuffer maps anonymous memory for the latency probe, aligned to 2MB and advised
+// to use transparent huge pages, so the sweep measures the caches rather than TLB misses.
+// huge reports whether the kernel accepted the advice; pages are still not guaranteed.
+func allocProbeBuffer(size int) (buf []byte, huge bool, free func(), err error) {
+	const hugePage = 2 << 20
+	mem, err := syscall.Mmap(-1, 0, size+hugePage, syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_PRIVATE|syscall.MAP_ANON)
+	if err != nil {
+		return nil, false, nil, err
+	}
+	off := 0
+	if r := int(uintptr(unsafe.Pointer(&mem[0])) % hugePage); r != 0 {
+		off = hugePage - r
+	}
+	buf = mem[off : off+size]
+	huge = syscall.Madvise(buf, syscall.MADV_HUGEPAGE) == nil
+	return buf, huge, func() { syscall.Munmap(mem) }, nil
+}
@@ -0,0 +1,9 @@
+//go:build !linux
+// +build !linux
+
+package cpuid
+
+// allocProbeBuffer allocates the latency probe buffer from the Go heap (4K pages).
+func allocProbeBuffer(size int) (buf []byte, huge bool, free func(), err error) {
+	return make([]byte, size), false, func() {}, nil
+}
@@ -0,0 +1,84 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+// subleafRule describes how the subleaves of a leaf are enumerated. The same rules drive
+// CaptureData and the decoders, so a dump holds every subleaf a decoder reads.
+type subleafRule struct {
+	max      uint32                                // highest subleaf ever visited
+	countEAX bool                                  // subleaf 0 EAX is the highest valid subleaf
+	sparse   bool                                  // all-zero subleaves above 1 are unused slots: skip them, keep going
+	end      func(subleaf, a, b, c, d uint32) bool // this subleaf and all above it are invalid (checked above subleaf 0)
+}
+
+func endCacheType(_, a, _, _, _ uint32) bool  { return a&0x1F == 0 }          // leaves 4, 0x8000001D
+func endLevelType(_, _, _, c, _ uint32) bool  { return (c>>8)&0xFF == 0 }     // leaves 0xB, 0x1F, 0x80000026
+func endSGXSection(s, a, _, _, _ uint32) bool { return s >= 2 && a&0xF == 0 } // leaf 0x12 EPC sections from subleaf 2
+func endPCONFIG(_, a, _, _, _ uint32) bool    { return a&0xFFF == 0 }         // leaf 0x1B target types
+
+// subleafRules lists the leaves with subleaves. Leaves not listed are read at subleaf 0 only.
+var subleafRules = map[uint32]subleafRule{
+	0x4:        {max: 63, end: endCacheType},  // deterministic cache parameters
+	0x7:        {max: 31, countEAX: true},     // structured extended features
+	0xB:        {max: 15, end: endLevelType},  // extended topology
+	0xD:        {max: 63, sparse: true},       // XSAVE state components
+	0xF:        {max: 15, sparse: true},       // RDT monitoring, subleaf = resource ID
+	0x10:       {max: 15, sparse: true},       // RDT allocation, subleaf = resource ID
+	0x12:       {max: 63, end: endSGXSection}, // SGX capabilities, attributes and EPC sections
+	0x14:       {max: 63, countEAX: true},     // Processor Trace
+	0x17:       {max: 63, countEAX: true},     // SoC vendor attributes
+	0x18:       {max: 63, countEAX: true},     // deterministic address translation
+	0x1B:       {max: 63, end: endPCONFIG},    // PCONFIG targets
+	0x1D:       {max: 255, countEAX: true},    // AMX tile palettes
+	0x1E:       {max: 255, countEAX: true},    // TMUL
+	0x1F:       {max: 15, end: endLevelType},  // V2 extended topology
+	0x20:       {max: 63, countEAX: true},     // processor history reset
+	0x23:       {max: 31, sparse: true},       // architectural performance monitoring extensions
+	0x24:       {max: 63, countEAX: true},     // AVX10
+	0x8000001D: {max: 63, end: endCacheType},  // AMD cache topology
+	0x80000020: {max: 15, sparse: true},       // AMD platform QoS, subleaf = resource ID
+	0x80000026: {max: 15, end: endLevelType},  // AMD extended CPU topology
+}
+
+// forEachSubleaf calls fn with every valid subleaf of leaf, as read through get, until fn returns false.
+// Subleaf 0 is always visited.
+func forEachSubleaf(leaf uint32, get func(leaf, subleaf uint32) (a, b, c, d uint32),
+	fn func(subleaf, a, b, c, d uint32) bool) {
+	rule, ok := subleafRules[leaf]
+	if !ok {
+		a, b, c, d := get(leaf, 0)
+		fn(0, a, b, c, d)
+		return
+	}
+
+	limit := rule.max
+	for subleaf := uint32(0); subleaf <= limit; subleaf++ {
+		a, b, c, d := get(leaf, subleaf)
+		if subleaf == 0 && rule.countEAX && a < limit {
+			limit = a
+		}
+		if subleaf > 0 && rule.end != nil && rule.end(subleaf, a, b, c, d) {
+			return
+		}
+		if subleaf > 1 && rule.sparse && a|b|c|d == 0 {
+			continue
+		}
+		if !fn(subleaf, a, b, c, d) {
+			return
+		}
+	}
+}
+
+// sourceGetter returns a leaf reader for a captured source; missing subleaves read as zeros.
+func sourceGetter(src leafSource) func(leaf, subleaf uint32) (a, b, c, d uint32) {
+	return func(leaf, subleaf uint32) (a, b, c, d uint32) {
+		a, b, c, d, _ = src.Lookup(leaf, subleaf)
+		return a, b, c, d
+	}
+}
+
+// modeGetter returns a leaf reader for the data source selected by offline and filename.
+func modeGetter(offline bool, filename string) func(leaf, subleaf uint32) (a, b, c, d uint32) {
+	return func(leaf, subleaf uint32) (a, b, c, d uint32) {
+		return CPUIDWithMode(leaf, subleaf, offline, filename)
+	}
+}
@@ -0,0 +1,18 @@
+//go:build !linux && !darwin
+// +build !linux,!darwin
+
+package cpuid
+
+import (
+	"io"
+	"os"
+)
+
+// mapFile reads the file into memory on platforms without a syscall.Mmap.
+func mapFile(file *os.File, size int) ([]byte, func([]byte) error, error) {
+	data := make([]byte, size)
+	if _, err := io.ReadFull(file, data); err != nil {
+		return nil, nil, err
+	}
+	return data, func([]byte) error { return nil }, nil
+}
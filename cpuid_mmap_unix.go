@@ -0,0 +1,18 @@
+//go:build linux || darwin
+// +build linux darwin
+
+package cpuid
+
+import (
+	"os"
+	"syscall"
+)
+
+// mapFile maps size bytes of the file read-only into memory.
+func mapFile(file *os.File, size int) ([]byte, func([]byte) error, error) {
+	data, err := syscall.Mmap(int(file.Fd()), 0, size, syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, nil, err
+	}
+	return data, syscall.Munmap, nil
+}
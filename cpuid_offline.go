@@ -0,0 +1,134 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"os"
+	"runtime"
+	"sync"
+)
+
+// leafSource answers cpuid queries from stored results.
+// It is implemented by Snapshot (JSON dumps) and BinaryDump (binary dumps).
+type leafSource interface {
+	Lookup(leaf, subleaf uint32) (a, b, c, d uint32, ok bool)
+}
+
+// offlineFile is a loaded dump file together with the stat data it was loaded from.
+type offlineFile struct {
+	src    leafSource
+	perCPU CPUSnapshots // nil unless the dump holds per-CPU data
+	stamp  fileStamp
+	path   []byte // the file name, NUL terminated, for statStamp
+
+	snapshotOnce sync.Once
+	snapshot     *Snapshot // LoadSnapshot result for binary dumps
+	derived
+}
+
+// fileStamp is the size and modification time (in ns since the Unix epoch) of a dump file.
+type fileStamp struct {
+	size    int64
+	modTime int64
+}
+
+var (
+	offlineMu    sync.RWMutex
+	offlineFiles = map[string]*offlineFile{}
+)
+
+// loadOffline returns the cached dump file, loading it once.
+// Binary dumps are memory mapped; JSON dumps are parsed into a Snapshot.
+// The cache entry is reused until the file's modification time or size changes.
+func loadOffline(filename string) (*offlineFile, error) {
+	// Use default filename if none provided.
+	if filename == "" {
+		filename = "cpuid_data.json"
+	}
+
+	offlineMu.RLock()
+	f := offlineFiles[filename]
+	offlineMu.RUnlock()
+	if f != nil {
+		if stamp, err := statStamp(f.path); err == nil && stamp == f.stamp {
+			statOfflineCacheHit()
+			return f, nil
+		}
+	}
+
+	info, err := os.Stat(filename)
+	if err != nil {
+		return nil, err
+	}
+
+	start := statNow()
+	f = &offlineFile{
+		stamp: fileStamp{size: info.Size(), modTime: info.ModTime().UnixNano()},
+		path:  append([]byte(filename), 0),
+	}
+	if IsBinaryDump(filename) {
+		dump, err := OpenBinaryDump(filename)
+		if err != nil {
+			return nil, err
+		}
+		// Callers may still hold a replaced dump, so it is unmapped once unreachable.
+		runtime.SetFinalizer(dump, (*BinaryDump).Close)
+		f.src = dump
+	} else {
+		data, err := DataFromFile(filename)
+		if err != nil {
+			return nil, err
+		}
+		f.src = NewSnapshot(data.Entries)
+		f.perCPU = PerCPUFromData(data)
+	}
+
+	offlineMu.Lock()
+	offlineFiles[filename] = f
+	offlineMu.Unlock()
+	statOfflineLoad(start)
+
+	return f, nil
+}
+
+// dropOffline removes a dump file from the cache, for callers that read many files once.
+func dropOffline(filename string) {
+	offlineMu.Lock()
+	delete(offlineFiles, filename)
+	offlineMu.Unlock()
+}
+
+// LoadSnapshot loads a dump file (JSON or binary) once and returns its indexed snapshot.
+// Later calls return the cached snapshot until the file's modification time or size changes.
+func LoadSnapshot(filename string) (*Snapshot, error) {
+	f, err := loadOffline(filename)
+	if err != nil {
+		return nil, err
+	}
+
+	if snap, ok := f.src.(*Snapshot); ok {
+		return snap, nil
+	}
+	f.snapshotOnce.Do(func() {
+		f.snapshot = NewSnapshot(f.src.(*BinaryDump).Data().Entries)
+	})
+	return f.snapshot, nil
+}
+
+// CPUIDWithModeErr is CPUIDWithMode with errors reported: in offline mode it fails
+// if the dump file cannot be read or parsed instead of returning zeros.
+// A leaf missing from a valid dump still returns zeros, matching a CPU that reports nothing for it.
+func CPUIDWithModeErr(eax, ecx uint32, offline bool, filename string) (a, b, c, d uint32, err error) {
+	if !offline {
+		a, b, c, d = currentLive().cpuid(eax, ecx)
+		return a, b, c, d, nil
+	}
+
+	f, err := loadOffline(filename)
+	if err != nil {
+		return 0, 0, 0, 0, err
+	}
+
+	statOfflineLookup()
+	a, b, c, d, _ = f.src.Lookup(eax, ecx)
+	return a, b, c, d, nil
+}
@@ -0,0 +1,44 @@
+package cpuid
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+)
+
+func TestLoadSnapshotCached(t *testing.T) {
+	for _, name := range []string{"spr_kvm.json", "spr_kvm.bin"} {
+		data, err := os.ReadFile(filepath.Join("testdata", name))
+		if err != nil {
+			t.Fatal(err)
+		}
+		filename := filepath.Join(t.TempDir(), name)
+		if err := os.WriteFile(filename, data, 0o644); err != nil {
+			t.Fatal(err)
+		}
+
+		first, err := LoadSnapshot(filename)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if again, _ := LoadSnapshot(filename); again != first {
+			t.Errorf("%s: LoadSnapshot rebuilt the snapshot of an unchanged file", name)
+		}
+
+		later := time.Now().Add(time.Hour)
+		if err := os.Chtimes(filename, later, later); err != nil {
+			t.Fatal(err)
+		}
+		reloaded, err := LoadSnapshot(filename)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if reloaded == first {
+			t.Errorf("%s: LoadSnapshot kept the snapshot of a modified file", name)
+		}
+		if reloaded.Len() != first.Len() {
+			t.Errorf("%s: reloaded %d entries, want %d", name, reloaded.Len(), first.Len())
+		}
+	}
+}
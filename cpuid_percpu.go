@@ -0,0 +1,91 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"fmt"
+	"sort"
+	"strconv"
+	"strings"
+)
+
+// CPUData holds the CPUID results captured on one logical CPU.
+type CPUData struct {
+	CPU     int     `json:"cpu"`
+	Entries []Entry `json:"entries"`
+}
+
+// CPUSnapshots maps a Linux CPU number to the snapshot captured while pinned to that CPU.
+type CPUSnapshots map[int]*Snapshot
+
+// CPUs returns the CPU numbers in the table in ascending order.
+func (s CPUSnapshots) CPUs() []int {
+	cpus := make([]int, 0, len(s))
+	for cpu := range s {
+		cpus = append(cpus, cpu)
+	}
+	sort.Ints(cpus)
+	return cpus
+}
+
+// Data serializes the table into the dump format. Entries holds the results of the lowest
+// numbered CPU, so the dump also works with every single-CPU API, and PerCPU holds all of them.
+func (s CPUSnapshots) Data() Data {
+	var data Data
+	for _, cpu := range s.CPUs() {
+		d := s[cpu].Data()
+		if data.Entries == nil {
+			data.Entries = d.Entries
+		}
+		data.PerCPU = append(data.PerCPU, CPUData{CPU: cpu, Entries: d.Entries})
+	}
+	return data
+}
+
+// PerCPUFromData rebuilds the per-CPU table from a dump written with per-CPU data.
+// It returns nil if the dump has none.
+func PerCPUFromData(data Data) CPUSnapshots {
+	if len(data.PerCPU) == 0 {
+		return nil
+	}
+	s := make(CPUSnapshots, len(data.PerCPU))
+	for _, c := range data.PerCPU {
+		s[c.CPU] = NewSnapshot(c.Entries)
+	}
+	return s
+}
+
+// CaptureDataPerCPU captures every online CPU with CapturePerCPU and writes the result as JSON.
+func CaptureDataPerCPU(filename string) error {
+	s, err := CapturePerCPU()
+	if err != nil {
+		return err
+	}
+	return writeJSONFile(filename, s.Data())
+}
+
+// parseCPUList parses a Linux CPU list such as "0-3,8,10-11".
+func parseCPUList(list string) ([]int, error) {
+	var cpus []int
+	list = strings.TrimSpace(list)
+	if list == "" {
+		return nil, nil
+	}
+
+	for _, part := range strings.Split(list, ",") {
+		lo, hi, isRange := strings.Cut(part, "-")
+		first, err := strconv.Atoi(lo)
+		if err != nil {
+			return nil, fmt.Errorf("invalid CPU list %q", list)
+		}
+		last := first
+		if isRange {
+			if last, err = strconv.Atoi(hi); err != nil || last < first {
+				return nil, fmt.Errorf("invalid CPU list %q", list)
+			}
+		}
+		for cpu := first; cpu <= last; cpu++ {
+			cpus = append(cpus, cpu)
+		}
+	}
+	return cpus, nil
+}
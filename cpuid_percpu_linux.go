@@ -0,0 +1,172 @@
+//go:build linux
+// +build linux
+
+package cpuid
+
+import (
+	"os"
+	"runtime"
+	"sync"
+	"syscall"
+	"unsafe"
+)
+
+// cpuMask is a sched_setaffinity CPU mask.
+type cpuMask [16]uint64 // 1024 CPUs, the kernel's default CONFIG_NR_CPUS upper range
+
+func (m *cpuMask) set(cpu int) {
+	m[cpu/64] |= 1 << (uint(cpu) % 64)
+}
+
+func (m *cpuMask) has(cpu int) bool {
+	return m[cpu/64]&(1<<(uint(cpu)%64)) != 0
+}
+
+func schedGetaffinity(m *cpuMask) error {
+	_, _, errno := syscall.RawSyscall(syscall.SYS_SCHED_GETAFFINITY, 0, unsafe.Sizeof(*m), uintptr(unsafe.Pointer(m)))
+	if errno != 0 {
+		return errno
+	}
+	return nil
+}
+
+func schedSetaffinity(m *cpuMask) error {
+	return setAffinity(m[:])
+}
+
+// setAffinity restricts the calling thread to the CPUs in a sched_setaffinity mask.
+func setAffinity(mask []uint64) error {
+	if len(mask) == 0 {
+		return syscall.EINVAL
+	}
+	_, _, errno := syscall.RawSyscall(syscall.SYS_SCHED_SETAFFINITY, 0, uintptr(len(mask)*8), uintptr(unsafe.Pointer(&mask[0])))
+	if errno != 0 {
+		return errno
+	}
+	return nil
+}
+
+// pinThread locks the calling goroutine to its OS thread and pins the thread to the first CPU it
+// may run on. restore puts back the previous affinity and unlocks the thread.
+func pinThread() (cpu int, restore func(), err error) {
+	runtime.LockOSThread()
+
+	var orig cpuMask
+	if err := schedGetaffinity(&orig); err != nil {
+		runtime.UnlockOSThread()
+		return -1, nil, err
+	}
+	cpu = -1
+	for c := 0; c < len(orig)*64; c++ {
+		if orig.has(c) {
+			cpu = c
+			break
+		}
+	}
+
+	var m cpuMask
+	m.set(cpu)
+	if err := schedSetaffinity(&m); err != nil {
+		runtime.UnlockOSThread()
+		return -1, nil, err
+	}
+	return cpu, func() {
+		// If the old mask cannot be restored, leave the thread locked so the runtime discards it.
+		if schedSetaffinity(&orig) == nil {
+			runtime.UnlockOSThread()
+		}
+	}, nil
+}
+
+// SetAffinity restricts the calling OS thread to the CPUs in the set.
+// Call runtime.LockOSThread first so the goroutine stays on that thread.
+func (s CPUSet) SetAffinity() error {
+	return setAffinity(s)
+}
+
+// usableCPUs returns the online CPUs this process is allowed to run on.
+func usableCPUs() ([]int, error) {
+	online, err := os.ReadFile("/sys/devices/system/cpu/online")
+	if err != nil {
+		return nil, err
+	}
+	cpus, err := parseCPUList(string(online))
+	if err != nil {
+		return nil, err
+	}
+
+	var allowed cpuMask
+	if err := schedGetaffinity(&allowed); err != nil {
+		return nil, err
+	}
+
+	usable := cpus[:0]
+	for _, cpu := range cpus {
+		if cpu < len(allowed)*64 && allowed.has(cpu) {
+			usable = append(usable, cpu)
+		}
+	}
+	return usable, nil
+}
+
+// onEachCPU runs fn on an OS thread pinned to each CPU in cpus, spreading the CPUs over up to
+// GOMAXPROCS worker threads. The workers never unlock their threads, so the runtime terminates
+// them on exit instead of reusing a thread with a narrowed affinity.
+func onEachCPU(cpus []int, fn func(i, cpu int)) error {
+	workers := runtime.GOMAXPROCS(0)
+	if workers > len(cpus) {
+		workers = len(cpus)
+	}
+
+	var (
+		wg       sync.WaitGroup
+		errMu    sync.Mutex
+		firstErr error
+	)
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func(w int) {
+			defer wg.Done()
+			runtime.LockOSThread()
+
+			for i := w; i < len(cpus); i += workers {
+				var m cpuMask
+				m.set(cpus[i])
+				if err := schedSetaffinity(&m); err != nil {
+					errMu.Lock()
+					if firstErr == nil {
+						firstErr = err
+					}
+					errMu.Unlock()
+					return
+				}
+				fn(i, cpus[i])
+			}
+		}(w)
+	}
+	wg.Wait()
+
+	return firstErr
+}
+
+// CapturePerCPU captures the full CPUID hierarchy on every online CPU the process may run on,
+// pinning a thread to each CPU in turn. The captures run in parallel on up to GOMAXPROCS threads.
+func CapturePerCPU() (CPUSnapshots, error) {
+	cpus, err := usableCPUs()
+	if err != nil {
+		return nil, err
+	}
+
+	snaps := make([]*Snapshot, len(cpus))
+	if err := onEachCPU(cpus, func(i, cpu int) {
+		snaps[i] = NewSnapshot(captureEntries())
+	}); err != nil {
+		return nil, err
+	}
+
+	table := make(CPUSnapshots, len(cpus))
+	for i, cpu := range cpus {
+		table[cpu] = snaps[i]
+	}
+	return table, nil
+}
@@ -0,0 +1,38 @@
+//go:build !linux
+// +build !linux
+
+package cpuid
+
+import (
+	"errors"
+	"runtime"
+)
+
+var errPerCPUUnsupported = errors.New("per-CPU capture is only supported on Linux")
+
+// onEachCPU is not supported without sched_setaffinity.
+func onEachCPU(cpus []int, fn func(i, cpu int)) error {
+	return errPerCPUUnsupported
+}
+
+// usableCPUs is not supported without sched_setaffinity.
+func usableCPUs() ([]int, error) {
+	return nil, errPerCPUUnsupported
+}
+
+// pinThread locks the calling goroutine to its OS thread; the thread is not pinned to a CPU
+// (cpu is -1) without sched_setaffinity.
+func pinThread() (cpu int, restore func(), err error) {
+	runtime.LockOSThread()
+	return -1, runtime.UnlockOSThread, nil
+}
+
+// CapturePerCPU is only supported on Linux.
+func CapturePerCPU() (CPUSnapshots, error) {
+	return nil, errPerCPUUnsupported
+}
+
+// SetAffinity is only supported on Linux.
+func (s CPUSet) SetAffinity() error {
+	return errPerCPUUnsupported
+}
@@ -0,0 +1,127 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"errors"
+	"sort"
+)
+
+func rdtsc() (lo, hi uint32)
+func rdtscp() (lo, hi, aux uint32)
+
+// VMExitCycles is the cost above which a leaf is reported as trapped by a hypervisor.
+// CPUID executes in roughly 100-300 cycles on bare metal, while a VM exit and re-entry
+// costs at least about a thousand.
+const VMExitCycles = 1000
+
+// LeafLatency is the measured cost of one (leaf, subleaf), in TSC cycles with the
+// timing overhead subtracted.
+type LeafLatency struct {
+	Leaf    uint32 `json:"leaf"`
+	Subleaf uint32 `json:"subleaf"`
+	Min     uint64 `json:"min"`
+	Median  uint64 `json:"median"`
+	P99     uint64 `json:"p99"`
+	VMExit  bool   `json:"vm_exit"` // Min is at least VMExitCycles
+}
+
+// LeafProfile is the result of ProfileLeaves.
+type LeafProfile struct {
+	CPU        int           `json:"cpu"` // CPU the measurements ran on, -1 if the thread could not be pinned
+	Iterations int           `json:"iterations"`
+	Overhead   uint64        `json:"overhead"` // minimum cycles of an empty timing pair
+	RDTSCP     bool          `json:"rdtscp"`   // false if the end time was read with LFENCE+RDTSC
+	Hypervisor bool          `json:"hypervisor"`
+	Leaves     []LeafLatency `json:"leaves"`
+}
+
+// Trapped returns the leaves whose cost shows a VM exit.
+func (p LeafProfile) Trapped() []LeafLatency {
+	var trapped []LeafLatency
+	for _, l := range p.Leaves {
+		if l.VMExit {
+			trapped = append(trapped, l)
+		}
+	}
+	return trapped
+}
+
+// ProfileLeaves executes every leaf and subleaf the CPU reports (the set CaptureData writes)
+// iterations times on a thread pinned to one CPU, timing each execution with RDTSC/RDTSCP.
+// Hypervisors that intercept CPUID show up as leaves costing VMExitCycles or more;
+// some trap every leaf, others only the ones they emulate.
+func ProfileLeaves(iterations int) (LeafProfile, error) {
+	if iterations < 1 {
+		return LeafProfile{}, errors.New("iterations must be at least 1")
+	}
+
+	cpu, restore, err := pinThread()
+	if err != nil {
+		return LeafProfile{}, err
+	}
+	defer restore()
+
+	maxExt, _, _, _ := cpuid(0x80000000, 0)
+	_, _, c, _ := cpuid(1, 0)
+	p := LeafProfile{
+		CPU:        cpu,
+		Iterations: iterations,
+		Hypervisor: c&(1<<31) != 0,
+	}
+	if maxExt >= 0x80000001 {
+		_, _, _, d := cpuid(0x80000001, 0)
+		p.RDTSCP = d&(1<<27) != 0
+	}
+
+	end := tscEnd(p.RDTSCP)
+	samples := make([]uint64, iterations)
+
+	// Calibrate the cost of the timing itself.
+	p.Overhead = ^uint64(0)
+	for i := 0; i < iterations; i++ {
+		lo, hi := rdtsc()
+		if d := end() - (uint64(hi)<<32 | uint64(lo)); d < p.Overhead {
+			p.Overhead = d
+		}
+	}
+
+	for _, e := range captureEntries() {
+		for i := range samples {
+			lo, hi := rdtsc()
+			cpuid(e.Leaf, e.Subleaf)
+			d := end() - (uint64(hi)<<32 | uint64(lo))
+			if d > p.Overhead {
+				d -= p.Overhead
+			} else {
+				d = 0
+			}
+			samples[i] = d
+		}
+
+		sort.Slice(samples, func(i, j int) bool { return samples[i] < samples[j] })
+		l := LeafLatency{
+			Leaf:    e.Leaf,
+			Subleaf: e.Subleaf,
+			Min:     samples[0],
+			Median:  samples[len(samples)/2],
+			P99:     samples[(len(samples)*99)/100],
+		}
+		l.VMExit = l.Min >= VMExitCycles
+		p.Leaves = append(p.Leaves, l)
+	}
+	return p, nil
+}
+
+// tscEnd returns the reader for the end of a timed region.
+func tscEnd(hasRDTSCP bool) func() uint64 {
+	if hasRDTSCP {
+		return func() uint64 {
+			lo, hi, _ := rdtscp()
+			return uint64(hi)<<32 | uint64(lo)
+		}
+	}
+	return func() uint64 {
+		lo, hi := rdtsc()
+		return uint64(hi)<<32 | uint64(lo)
+	}
+}
@@ -0,0 +1,169 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"sync"
+	"sync/atomic"
+)
+
+// Snapshot is an immutable set of CPUID results indexed by leaf and subleaf.
+// It is safe for concurrent use without locking.
+type Snapshot struct {
+	regs    map[uint64][4]uint32
+	entries []Entry
+
+	fingerprintOnce sync.Once
+	fingerprint     Fingerprint
+}
+
+// liveSnapshot is the process-wide snapshot of the CPU the program runs on.
+// Leaves that were not part of the initial capture (subleafs past a termination
+// condition, leaves only some callers walk) are executed once on first use and memoized.
+type liveSnapshot struct {
+	*Snapshot
+	misses sync.Map // leafKey -> [4]uint32
+	derived
+}
+
+// derived holds values computed once from a data source (the live snapshot or an offline file)
+// and dropped together with it.
+type derived struct {
+	vendorOnce      sync.Once
+	vendor          Vendor
+	featuresOnce    sync.Once
+	features        FeatureMask
+	usableOnce      sync.Once
+	usable          FeatureMask
+	cpusOnce        sync.Once
+	cpuNums         []int
+	cpuSrcs         []leafSource
+	cpusErr         error
+	topologyOnce    sync.Once
+	topology        *Topology
+	cacheOnce       sync.Once
+	caches          []CacheDomain
+	fingerprintOnce sync.Once
+	fingerprint     Fingerprint
+}
+
+// derivedFor returns the derived values of the data source selected by offline and filename,
+// or nil if the offline file cannot be loaded.
+func derivedFor(offline bool, filename string) *derived {
+	if !offline {
+		return &currentLive().derived
+	}
+
+	f, err := loadOffline(filename)
+	if err != nil {
+		return nil
+	}
+	return &f.derived
+}
+
+// sourceFor returns the CPUID results of the data source selected by offline and filename,
+// or nil if the offline file cannot be loaded.
+func sourceFor(offline bool, filename string) leafSource {
+	if !offline {
+		return currentLive().Snapshot
+	}
+
+	f, err := loadOffline(filename)
+	if err != nil {
+		return nil
+	}
+	return f.src
+}
+
+var (
+	live   atomic.Pointer[liveSnapshot]
+	liveMu sync.Mutex
+)
+
+// leafKey packs a leaf and subleaf into a single index key.
+func leafKey(leaf, subleaf uint32) uint64 {
+	return uint64(leaf)<<32 | uint64(subleaf)
+}
+
+// NewSnapshot builds an indexed snapshot from a list of entries.
+// If an entry appears more than once the last one wins.
+func NewSnapshot(entries []Entry) *Snapshot {
+	s := &Snapshot{
+		regs:    make(map[uint64][4]uint32, len(entries)),
+		entries: make([]Entry, len(entries)),
+	}
+	copy(s.entries, entries)
+	for _, e := range entries {
+		s.regs[leafKey(e.Leaf, e.Subleaf)] = [4]uint32{e.EAX, e.EBX, e.ECX, e.EDX}
+	}
+	return s
+}
+
+// Lookup returns the registers stored for the given leaf and subleaf, and whether they were present.
+func (s *Snapshot) Lookup(leaf, subleaf uint32) (a, b, c, d uint32, ok bool) {
+	r, ok := s.regs[leafKey(leaf, subleaf)]
+	return r[0], r[1], r[2], r[3], ok
+}
+
+// Len returns the number of (leaf, subleaf) results in the snapshot.
+func (s *Snapshot) Len() int {
+	return len(s.entries)
+}
+
+// Data returns a copy of the snapshot entries in capture order.
+func (s *Snapshot) Data() Data {
+	entries := make([]Entry, len(s.entries))
+	copy(entries, s.entries)
+	return Data{Entries: entries}
+}
+
+// LiveSnapshot returns the process-wide snapshot of the current CPU, capturing it on first use.
+func LiveSnapshot() *Snapshot {
+	return currentLive().Snapshot
+}
+
+// Refresh discards the process-wide snapshot and captures the CPU again.
+// Use it when fresh values are required, for example after a microcode update or VM migration.
+func Refresh() *Snapshot {
+	s := &liveSnapshot{Snapshot: NewSnapshot(captureEntries())}
+
+	liveMu.Lock()
+	live.Store(s)
+	liveMu.Unlock()
+
+	return s.Snapshot
+}
+
+func currentLive() *liveSnapshot {
+	if s := live.Load(); s != nil {
+		return s
+	}
+
+	liveMu.Lock()
+	defer liveMu.Unlock()
+	if s := live.Load(); s != nil {
+		return s
+	}
+
+	s := &liveSnapshot{Snapshot: NewSnapshot(captureEntries())}
+	live.Store(s)
+	return s
+}
+
+// cpuid returns the snapshot value for the given leaf and subleaf, executing
+// the instruction only for results the capture did not cover.
+func (s *liveSnapshot) cpuid(leaf, subleaf uint32) (a, b, c, d uint32) {
+	statLiveQuery()
+	if a, b, c, d, ok := s.Lookup(leaf, subleaf); ok {
+		return a, b, c, d
+	}
+
+	key := leafKey(leaf, subleaf)
+	if r, ok := s.misses.Load(key); ok {
+		regs := r.([4]uint32)
+		return regs[0], regs[1], regs[2], regs[3]
+	}
+
+	a, b, c, d = execCPUID(leaf, subleaf)
+	s.misses.Store(key, [4]uint32{a, b, c, d})
+	return a, b, c, d
+}
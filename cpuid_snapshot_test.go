@@ -0,0 +1,72 @@
+package cpuid
+
+import (
+	"fmt"
+	"testing"
+)
+
+// BenchmarkLiveQuery compares a live query served from the process-wide snapshot with executing
+// the CPUID instruction, which is what every query cost before the snapshot. On virtualized
+// hosts the instruction is a VM exit.
+func BenchmarkLiveQuery(b *testing.B) {
+	LiveSnapshot()
+	for _, leaf := range []uint32{0, 1, 7, 0x80000002} {
+		b.Run(fmt.Sprintf("leaf=0x%X/snapshot", leaf), func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				CPUIDWithMode(leaf, 0, false, "")
+			}
+		})
+		b.Run(fmt.Sprintf("leaf=0x%X/cpuid", leaf), func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				cpuid(leaf, 0)
+			}
+		})
+	}
+}
+
+// BenchmarkLiveGetters runs getters that issue several queries, once from the snapshot
+// and once with every query executing CPUID.
+func BenchmarkLiveGetters(b *testing.B) {
+	maxFunc, maxExtFunc := GetMaxFunctions(false, "")
+	getters := []struct {
+		name string
+		fn   func(get func(leaf, subleaf uint32) (a, b, c, d uint32))
+	}{
+		{"BrandString", func(get func(leaf, subleaf uint32) (a, b, c, d uint32)) {
+			for leaf := uint32(0x80000002); leaf <= 0x80000004; leaf++ {
+				get(leaf, 0)
+			}
+		}},
+		{"Caches", func(get func(leaf, subleaf uint32) (a, b, c, d uint32)) {
+			cachesOfLeaf(4, get)
+		}},
+		{"TLBs", func(get func(leaf, subleaf uint32) (a, b, c, d uint32)) {
+			intelTLBInfo(maxFunc, get)
+		}},
+	}
+	if maxExtFunc < 0x80000004 || !GetVendor(false, "").IntelCompatible() {
+		b.Skip("needs an Intel-compatible CPU with a brand string")
+	}
+
+	for _, g := range getters {
+		b.Run(g.name+"/snapshot", func(b *testing.B) {
+			get := modeGetter(false, "")
+			for i := 0; i < b.N; i++ {
+				g.fn(get)
+			}
+		})
+		b.Run(g.name+"/cpuid", func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				g.fn(cpuid)
+			}
+		})
+	}
+}
+
+// BenchmarkRefresh measures a full recapture of the live snapshot.
+func BenchmarkRefresh(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		Refresh()
+	}
+}
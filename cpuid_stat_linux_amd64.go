@@ -0,0 +1,8 @@
+//go:build linux && amd64
+// +build linux,amd64
+
+package cpuid
+
+import "syscall"
+
+const fstatatTrap = syscall.SYS_NEWFSTATAT
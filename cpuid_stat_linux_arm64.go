@@ -0,0 +1,8 @@
+//go:build linux && arm64
+// +build linux,arm64
+
+package cpuid
+
+import "syscall"
+
+const fstatatTrap = syscall.SYS_FSTATAT
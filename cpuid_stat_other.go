@@ -0,0 +1,15 @@
+//go:build !linux || !(amd64 || arm64)
+// +build !linux !amd64,!arm64
+
+package cpuid
+
+import "os"
+
+// statStamp returns the stamp of the NUL-terminated path.
+func statStamp(path []byte) (fileStamp, error) {
+	info, err := os.Stat(string(path[:len(path)-1]))
+	if err != nil {
+		return fileStamp{}, err
+	}
+	return fileStamp{size: info.Size(), modTime: info.ModTime().UnixNano()}, nil
+}
@@ -0,0 +1,46 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import "time"
+
+// LeafCounter is the number of times the cpuid instruction ran for one leaf and the time it took.
+type LeafCounter struct {
+	Leaf       uint32        `json:"leaf"`
+	Executions uint64        `json:"executions"`
+	Time       time.Duration `json:"time_ns"`
+}
+
+// Counters is a snapshot of the library's instrumentation counters, see Stats.
+type Counters struct {
+	Enabled bool `json:"enabled"` // false when built with the cpuidnostats tag
+
+	LiveQueries    uint64        `json:"live_queries"`    // CPUIDWithMode calls answered by the live snapshot
+	LiveExecutions uint64        `json:"live_executions"` // cpuid instructions executed (captures and snapshot misses)
+	LiveTime       time.Duration `json:"live_time_ns"`    // time spent executing them
+	Leaves         []LeafCounter `json:"leaves"`          // executions per leaf, leaves that never ran are omitted
+
+	OfflineLookups   uint64        `json:"offline_lookups"`    // leaf lookups in dump files
+	OfflineLoads     uint64        `json:"offline_loads"`      // dump files read and indexed
+	OfflineLoadTime  time.Duration `json:"offline_load_ns"`    // time spent loading them
+	OfflineCacheHits uint64        `json:"offline_cache_hits"` // dump file requests served by an already loaded file
+}
+
+// statsLeafSlots is the number of leaves tracked per range (standard, hypervisor, extended);
+// executions of leaves past it are added to the last slot of their range.
+const statsLeafSlots = 64
+
+// statsLeafRanges are the first leaves of the tracked ranges.
+var statsLeafRanges = [3]uint32{0, 0x40000000, 0x80000000}
+
+// statsLeafSlot maps a leaf to its range and slot.
+func statsLeafSlot(leaf uint32) (rng, slot int) {
+	rng = int(leaf >> 30)
+	if rng > 2 {
+		rng = 2
+	}
+	off := leaf - statsLeafRanges[rng]
+	if off >= statsLeafSlots {
+		off = statsLeafSlots - 1
+	}
+	return rng, int(off)
+}
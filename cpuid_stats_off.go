@@ -0,0 +1,25 @@
+//go:build cpuidnostats
+// +build cpuidnostats
+
+package cpuid
+
+import "time"
+
+// execCPUID executes the cpuid instruction.
+func execCPUID(leaf, subleaf uint32) (a, b, c, d uint32) {
+	return cpuid(leaf, subleaf)
+}
+
+func statLiveQuery()            {}
+func statOfflineLookup()        {}
+func statOfflineCacheHit()      {}
+func statOfflineLoad(time.Time) {}
+func statNow() (t time.Time)    { return t }
+
+// Stats returns empty counters: the library was built with the cpuidnostats tag.
+func Stats() Counters {
+	return Counters{}
+}
+
+// ResetStats does nothing: the library was built with the cpuidnostats tag.
+func ResetStats() {}
@@ -0,0 +1,126 @@
+//go:build !cpuidnostats
+// +build !cpuidnostats
+
+package cpuid
+
+import (
+	"sync/atomic"
+	"time"
+	"unsafe"
+)
+
+// counter is an atomic counter on its own cache line, so hot counters updated
+// from many goroutines do not contend with each other.
+type counter struct {
+	n uint64
+	_ [56]byte
+}
+
+func (c *counter) add(n uint64) { atomic.AddUint64(&c.n, n) }
+func (c *counter) load() uint64 { return atomic.LoadUint64(&c.n) }
+func (c *counter) reset()       { atomic.StoreUint64(&c.n, 0) }
+
+// statsStripes is the number of slots of a stripedCounter, a power of two.
+const statsStripes = 32
+
+// stripedCounter spreads a counter bumped on every query over several cache lines.
+// Each goroutine adds to the slot picked by its stack address, so goroutines running
+// in parallel rarely share a line; load sums the slots.
+type stripedCounter [statsStripes]counter
+
+func (c *stripedCounter) add(n uint64) {
+	var marker byte
+	// Goroutine stacks are at least 2 KiB apart.
+	c[uintptr(unsafe.Pointer(&marker))>>11&(statsStripes-1)].add(n)
+}
+
+func (c *stripedCounter) load() (n uint64) {
+	for i := range c {
+		n += c[i].load()
+	}
+	return n
+}
+
+func (c *stripedCounter) reset() {
+	for i := range c {
+		c[i].reset()
+	}
+}
+
+var stats struct {
+	liveQueries      stripedCounter
+	offlineLookups   counter
+	offlineCacheHits counter
+	offlineLoads     counter
+	offlineLoadNanos counter
+
+	leafExecutions [3][statsLeafSlots]uint64
+	leafNanos      [3][statsLeafSlots]uint64
+}
+
+// execCPUID executes the cpuid instruction and counts the execution.
+func execCPUID(leaf, subleaf uint32) (a, b, c, d uint32) {
+	start := time.Now()
+	a, b, c, d = cpuid(leaf, subleaf)
+	elapsed := time.Since(start)
+
+	rng, slot := statsLeafSlot(leaf)
+	atomic.AddUint64(&stats.leafExecutions[rng][slot], 1)
+	atomic.AddUint64(&stats.leafNanos[rng][slot], uint64(elapsed))
+	return a, b, c, d
+}
+
+func statLiveQuery()       { stats.liveQueries.add(1) }
+func statOfflineLookup()   { stats.offlineLookups.add(1) }
+func statOfflineCacheHit() { stats.offlineCacheHits.add(1) }
+
+// statOfflineLoad counts a dump file load that started at start.
+func statOfflineLoad(start time.Time) {
+	stats.offlineLoads.add(1)
+	stats.offlineLoadNanos.add(uint64(time.Since(start)))
+}
+
+// statNow returns the start time for statOfflineLoad.
+func statNow() time.Time { return time.Now() }
+
+// Stats returns a snapshot of the instrumentation counters. The counters are updated atomically
+// but read one by one, so a snapshot taken under load may be slightly inconsistent.
+// Build with the cpuidnostats tag to compile the counters out.
+func Stats() Counters {
+	c := Counters{
+		Enabled:          true,
+		LiveQueries:      stats.liveQueries.load(),
+		OfflineLookups:   stats.offlineLookups.load(),
+		OfflineLoads:     stats.offlineLoads.load(),
+		OfflineLoadTime:  time.Duration(stats.offlineLoadNanos.load()),
+		OfflineCacheHits: stats.offlineCacheHits.load(),
+	}
+	for rng := range stats.leafExecutions {
+		for slot := range stats.leafExecutions[rng] {
+			n := atomic.LoadUint64(&stats.leafExecutions[rng][slot])
+			if n == 0 {
+				continue
+			}
+			t := time.Duration(atomic.LoadUint64(&stats.leafNanos[rng][slot]))
+			c.Leaves = append(c.Leaves, LeafCounter{Leaf: statsLeafRanges[rng] + uint32(slot), Executions: n, Time: t})
+			c.LiveExecutions += n
+			c.LiveTime += t
+		}
+	}
+	return c
+}
+
+// ResetStats sets every instrumentation counter back to zero.
+func ResetStats() {
+	stats.liveQueries.reset()
+	stats.offlineLookups.reset()
+	stats.offlineCacheHits.reset()
+	stats.offlineLoads.reset()
+	stats.offlineLoadNanos.reset()
+	for rng := range stats.leafExecutions {
+		for slot := range stats.leafExecutions[rng] {
+			atomic.StoreUint64(&stats.leafExecutions[rng][slot], 0)
+			atomic.StoreUint64(&stats.leafNanos[rng][slot], 0)
+		}
+	}
+}
@@ -0,0 +1,56 @@
+//go:build !cpuidnostats
+// +build !cpuidnostats
+
+package cpuid
+
+import (
+	"sync"
+	"testing"
+)
+
+func TestStatsCountsLiveQueries(t *testing.T) {
+	LiveSnapshot()
+	ResetStats()
+
+	const goroutines, queries = 8, 1000
+	var wg sync.WaitGroup
+	for g := 0; g < goroutines; g++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := 0; i < queries; i++ {
+				CPUIDWithMode(1, 0, false, "")
+			}
+		}()
+	}
+	wg.Wait()
+
+	if got := Stats().LiveQueries; got != goroutines*queries {
+		t.Errorf("LiveQueries = %d, want %d", got, goroutines*queries)
+	}
+	ResetStats()
+	if got := Stats().LiveQueries; got != 0 {
+		t.Errorf("LiveQueries = %d after ResetStats, want 0", got)
+	}
+}
+
+// BenchmarkLiveQueryCounter compares the striped live query counter with a single atomic
+// counter under RunParallel; the difference shows with more than one P.
+func BenchmarkLiveQueryCounter(b *testing.B) {
+	b.Run("single", func(b *testing.B) {
+		var c counter
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				c.add(1)
+			}
+		})
+	})
+	b.Run("striped", func(b *testing.B) {
+		var c stripedCounter
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				c.add(1)
+			}
+		})
+	})
+}
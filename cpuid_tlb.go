@@ -8,87 +8,125 @@ import (
 
 // GetTLBInfo returns TLB information for the CPU
 func GetTLBInfo(maxFunc, maxExtFunc uint32, offline bool, filename string) (TLBInfo, error) {
-	if isAMD(offline, filename) {
+	vendor := GetVendor(offline, filename)
+	if vendor.AMDCompatible() {
 		return GetAMDTLBInfo(maxExtFunc, offline, filename), nil
 	}
 
-	if isIntel(offline, filename) {
+	if vendor.IntelCompatible() {
 		return GetIntelTLBInfo(maxFunc, offline, filename), nil
 	}
 
 	return TLBInfo{}, fmt.Errorf("Unknown/Unsupported CPU vendor")
 }
 
+// tlbInfoOf decodes the TLBs read through get, choosing the leaves by the vendor as GetTLBInfo does.
+// ok is false for other vendors.
+func tlbInfoOf(get func(leaf, subleaf uint32) (a, b, c, d uint32)) (info TLBInfo, ok bool) {
+	maxFunc, b, c, d := get(0, 0)
+	switch vendor := vendorFromRegisters(b, c, d); {
+	case vendor.AMDCompatible():
+		maxExtFunc, _, _, _ := get(0x80000000, 0)
+		return amdTLBInfo(maxExtFunc, get), true
+	case vendor.IntelCompatible():
+		return intelTLBInfo(maxFunc, get), true
+	}
+	return TLBInfo{}, false
+}
+
 // GetAMDTLBInfo retrieves TLB information for AMD processors
 func GetAMDTLBInfo(maxExtFunc uint32, offline bool, filename string) TLBInfo {
+	return amdTLBInfo(maxExtFunc, modeGetter(offline, filename))
+}
+
+func amdTLBInfo(maxExtFunc uint32, get func(leaf, subleaf uint32) (a, b, c, d uint32)) TLBInfo {
 	info := TLBInfo{
 		Vendor: "AMD",
 	}
 
-	// L1 TLB info from 0x80000005
-	a, b, _, _ := CPUIDWithMode(0x80000005, 0, offline, filename)
+	// L1 TLB info from 0x80000005: EAX describes the 2M/4M page TLBs, EBX the 4K page TLBs,
+	// each with the data TLB in the upper and the instruction TLB in the lower 16 bits. The 8-bit
+	// associativity fields hold the number of ways.
+	a, b, _, _ := get(0x80000005, 0)
 
 	// L1 Data TLB
 	info.L1.Data = append(info.L1.Data, TLBEntry{
 		PageSize:      "2MB/4MB",
 		Entries:       int((a >> 16) & 0xFF),
-		Associativity: getAMDAssociativity((a >> 8) & 0xFF),
+		Associativity: amdL1Associativity((a >> 24) & 0xFF),
 	})
 	info.L1.Data = append(info.L1.Data, TLBEntry{
 		PageSize:      "4KB",
-		Entries:       int((a >> 24) & 0xFF),
-		Associativity: getAMDAssociativity((a >> 8) & 0xFF),
+		Entries:       int((b >> 16) & 0xFF),
+		Associativity: amdL1Associativity((b >> 24) & 0xFF),
 	})
 
 	// L1 Instruction TLB
 	info.L1.Instruction = append(info.L1.Instruction, TLBEntry{
 		PageSize:      "2MB/4MB",
-		Entries:       int((b >> 16) & 0xFF),
-		Associativity: getAMDAssociativity((b >> 8) & 0xFF),
+		Entries:       int(a & 0xFF),
+		Associativity: amdL1Associativity((a >> 8) & 0xFF),
 	})
 	info.L1.Instruction = append(info.L1.Instruction, TLBEntry{
 		PageSize:      "4KB",
-		Entries:       int((b >> 24) & 0xFF),
-		Associativity: getAMDAssociativity((b >> 8) & 0xFF),
+		Entries:       int(b & 0xFF),
+		Associativity: amdL1Associativity((b >> 8) & 0xFF),
 	})
 
-	// L2 TLB info from 0x80000006 if available
+	// L2 TLB info from 0x80000006 if available, laid out like 0x80000005 with 12-bit entry counts
+	// and encoded 4-bit associativity fields.
 	if maxExtFunc >= 0x80000006 {
-		a, b, _, _ = CPUIDWithMode(0x80000006, 0, offline, filename)
+		a, b, _, _ = get(0x80000006, 0)
 
 		// L2 Data TLB
 		info.L2.Data = append(info.L2.Data, TLBEntry{
 			PageSize:      "2MB/4MB",
 			Entries:       int((a >> 16) & 0xFFF),
-			Associativity: getAMDAssociativity((a >> 12) & 0xF),
+			Associativity: getAMDAssociativity((a >> 28) & 0xF),
 		})
 		info.L2.Data = append(info.L2.Data, TLBEntry{
 			PageSize:      "4KB",
-			Entries:       int((a >> 28) & 0xF),
-			Associativity: getAMDAssociativity((a >> 12) & 0xF),
+			Entries:       int((b >> 16) & 0xFFF),
+			Associativity: getAMDAssociativity((b >> 28) & 0xF),
 		})
 
 		// L2 Instruction TLB
 		info.L2.Instruction = append(info.L2.Instruction, TLBEntry{
 			PageSize:      "2MB/4MB",
-			Entries:       int((b >> 16) & 0xFFF),
-			Associativity: getAMDAssociativity((b >> 12) & 0xF),
+			Entries:       int(a & 0xFFF),
+			Associativity: getAMDAssociativity((a >> 12) & 0xF),
 		})
 		info.L2.Instruction = append(info.L2.Instruction, TLBEntry{
 			PageSize:      "4KB",
-			Entries:       int((b >> 28) & 0xF),
+			Entries:       int(b & 0xFFF),
 			Associativity: getAMDAssociativity((b >> 12) & 0xF),
 		})
 
-		// L3 TLB info if supported
+		// 1GB page TLBs from 0x80000019 if available: EAX describes the L1 and EBX the L2 TLBs,
+		// laid out like 0x80000006.
 		if maxExtFunc >= 0x80000019 {
-			a, _, _, _ = CPUIDWithMode(0x80000019, 0, offline, filename)
+			a, b, _, _ = get(0x80000019, 0)
 
-			info.L3.Data = append(info.L3.Data, TLBEntry{
+			info.L1.Data = append(info.L1.Data, TLBEntry{
 				PageSize:      "1GB",
 				Entries:       int((a >> 16) & 0xFFF),
+				Associativity: getAMDAssociativity((a >> 28) & 0xF),
+			})
+			info.L1.Instruction = append(info.L1.Instruction, TLBEntry{
+				PageSize:      "1GB",
+				Entries:       int(a & 0xFFF),
 				Associativity: getAMDAssociativity((a >> 12) & 0xF),
 			})
+			info.L2.Data = append(info.L2.Data, TLBEntry{
+				PageSize:      "1GB",
+				Entries:       int((b >> 16) & 0xFFF),
+				Associativity: getAMDAssociativity((b >> 28) & 0xF),
+			})
+			info.L2.Instruction = append(info.L2.Instruction, TLBEntry{
+				PageSize:      "1GB",
+				Entries:       int(b & 0xFFF),
+				Associativity: getAMDAssociativity((b >> 12) & 0xF),
+			})
 		}
 	}
 
@@ -97,6 +135,10 @@ func GetAMDTLBInfo(maxExtFunc uint32, offline bool, filename string) TLBInfo {
 
 // GetIntelTLBInfo retrieves TLB information for Intel processors
 func GetIntelTLBInfo(maxFunc uint32, offline bool, filename string) TLBInfo {
+	return intelTLBInfo(maxFunc, modeGetter(offline, filename))
+}
+
+func intelTLBInfo(maxFunc uint32, get func(leaf, subleaf uint32) (a, b, c, d uint32)) TLBInfo {
 	info := TLBInfo{
 		Vendor: "Intel",
 	}
@@ -105,31 +147,32 @@ func GetIntelTLBInfo(maxFunc uint32, offline bool, filename string) TLBInfo {
 		return info
 	}
 
-	// Process traditional descriptors (leaf 0x2)
-	a, b, c, d := CPUIDWithMode(0x2, 0, offline, filename)
-	processIntelDescriptors(&info, a>>8, b, c, d)
+	// Process traditional descriptors (leaf 0x2); AL is the iteration count, not a descriptor
+	a, b, c, d := get(0x2, 0)
+	processIntelDescriptors(&info, a&^0xFF, b, c, d)
 
-	// Process structured TLB information (leaf 0x18)
+	// Process structured TLB information (leaf 0x18). Subleaf 0 EAX is the highest subleaf;
+	// subleafs with TLB type 0 are invalid and skipped.
 	if maxFunc >= 0x18 {
-		subleaf := uint32(0)
-		for {
-			_, b, c, d = CPUIDWithMode(0x18, subleaf, offline, filename)
-
-			if (d & 0x1F) != 1 { // 1 indicates TLB entry
-				break
+		forEachSubleaf(0x18, get, func(_, _, b, c, d uint32) bool {
+			tlbType := getTLBType(d & 0x1F)
+			if tlbType == "Invalid" {
+				return true
 			}
 
+			ways := b >> 16
+			associativity := fmt.Sprintf("%d-way", ways)
+			if d&(1<<8) != 0 {
+				associativity = "Fully associative"
+			}
 			entry := TLBEntry{
 				PageSize:      getTLBPageSize(b),
-				Entries:       int((b>>16)&0xFFF) + 1,
-				Associativity: getIntelAssociativity(b >> 8),
+				Entries:       int(ways * c), // ways x sets
+				Associativity: associativity,
 			}
 
-			level := (c >> 5) & 0x7
-			tlbType := getTLBType((c >> 8) & 0x3)
-
 			// Add entry to appropriate level and type
-			switch level {
+			switch (d >> 5) & 0x7 {
 			case 1:
 				addIntelTLBEntry(&info.L1, tlbType, entry)
 			case 2:
@@ -137,32 +180,26 @@ func GetIntelTLBInfo(maxFunc uint32, offline bool, filename string) TLBInfo {
 			case 3:
 				addIntelTLBEntry(&info.L3, tlbType, entry)
 			}
-
-			subleaf++
-		}
+			return true
+		})
 	}
 
 	return info
 }
 
-// getTLBPageSize converts Intel's page size value to a string description
+// getTLBPageSize converts the page size bits of leaf 0x18 EBX[3:0] (4K, 2M, 4M, 1G)
+// to a string description such as "4KB/2MB"
 func getTLBPageSize(value uint32) string {
-	switch value & 0xF {
-	case 1:
-		return "4KB"
-	case 2:
-		return "2MB"
-	case 3:
-		return "4MB"
-	case 4:
-		return "1GB"
-	case 5:
-		return "256MB"
-	case 0xF:
-		return "Reserved"
-	default:
+	var sizes []string
+	for i, name := range []string{"4KB", "2MB", "4MB", "1GB"} {
+		if value&(1<<i) != 0 {
+			sizes = append(sizes, name)
+		}
+	}
+	if len(sizes) == 0 {
 		return "Unknown"
 	}
+	return strings.Join(sizes, "/")
 }
 
 // Helper function to add Intel TLB entry to appropriate slice
@@ -177,12 +214,13 @@ func addIntelTLBEntry(level *TLBLevel, tlbType string, entry TLBEntry) {
 	}
 }
 
-// getTLBType converts Intel's TLB type value to a string description
+// getTLBType converts the TLB type of leaf 0x18 EDX[4:0] to a string description.
+// Load-only and store-only TLBs are reported as data TLBs.
 func getTLBType(value uint32) string {
 	switch value {
 	case 0:
 		return "Invalid"
-	case 1:
+	case 1, 4, 5:
 		return "Data"
 	case 2:
 		return "Instruction"
@@ -196,7 +234,8 @@ func getTLBType(value uint32) string {
 // Helper function to process Intel descriptors and add them to TLBInfo
 func processIntelDescriptors(info *TLBInfo, bytes ...uint32) {
 	for _, val := range bytes {
-		if val == 0 {
+		// Bit 31 set marks a register without valid descriptors
+		if val == 0 || val&(1<<31) != 0 {
 			continue
 		}
 
@@ -230,64 +269,36 @@ func parseIntelDescriptor(descriptor uint32) *TLBEntry {
 	return nil
 }
 
-// getAMDAssociativity converts AMD's associativity value to a string description
-func getAMDAssociativity(value uint32) string {
+// amdL1Associativity converts the 8-bit associativity of 0x80000005, a number of ways,
+// to a string description
+func amdL1Associativity(value uint32) string {
 	switch value {
 	case 0:
 		return "Reserved"
 	case 1:
 		return "1-way (direct mapped)"
-	case 2:
-		return "2-way"
-	case 4:
-		return "4-way"
-	case 6:
-		return "6-way"
-	case 8:
-		return "8-way"
-	case 0xF:
+	case 0xFF:
 		return "Fully associative"
 	default:
 		return fmt.Sprintf("%d-way", value)
 	}
 }
 
-// getIntelAssociativity converts Intel's associativity value to a string description
-func getIntelAssociativity(value uint32) string {
+// getAMDAssociativity converts the encoded 4-bit associativity of 0x80000006 and 0x80000019
+// to a string description
+func getAMDAssociativity(value uint32) string {
 	switch value {
 	case 0:
 		return "Reserved"
 	case 1:
-		return "Direct mapped"
-	case 2:
-		return "2-way"
-	case 3:
-		return "3-way"
-	case 4:
-		return "4-way"
-	case 5:
-		return "6-way"
-	case 6:
-		return "8-way"
-	case 7:
-		return "12-way"
-	case 8:
-		return "16-way"
-	case 9:
-		return "32-way"
-	case 10:
-		return "48-way"
-	case 11:
-		return "64-way"
-	case 12:
-		return "96-way"
-	case 13:
-		return "128-way"
-	case 14:
+		return "1-way (direct mapped)"
+	case 0xF:
 		return "Fully associative"
-	case 15:
-		return "Reserved"
-	default:
-		return fmt.Sprintf("Unknown (%d)", value)
 	}
+	if value < 16 {
+		if ways := [16]int{2: 2, 3: 3, 4: 4, 5: 6, 6: 8, 8: 16, 0xA: 32, 0xB: 48, 0xC: 64, 0xD: 96, 0xE: 128}[value]; ways != 0 {
+			return fmt.Sprintf("%d-way", ways)
+		}
+	}
+	return "Reserved"
 }
@@ -0,0 +1,121 @@
+package cpuid
+
+import (
+	"reflect"
+	"testing"
+)
+
+// leafGetter returns a leaf reader over regs, keyed by leaf and subleaf; missing ones read as zeros.
+func leafGetter(regs map[[2]uint32][4]uint32) func(leaf, subleaf uint32) (a, b, c, d uint32) {
+	return func(leaf, subleaf uint32) (a, b, c, d uint32) {
+		r := regs[[2]uint32{leaf, subleaf}]
+		return r[0], r[1], r[2], r[3]
+	}
+}
+
+func TestAMDTLBInfo(t *testing.T) {
+	// 0x80000005 and 0x80000006 as a Zen 2 part reports them. The 0x80000019 values are made up so
+	// that every field differs, with the encoded associativities 0xF, 6, 8 and 5.
+	get := leafGetter(map[[2]uint32][4]uint32{
+		{0x80000005, 0}: {0xFF40FF40, 0xFF40FF40, 0x20080140, 0x20080140},
+		{0x80000006, 0}: {0x48002200, 0x68004200, 0x02006140, 0x01009140},
+		{0x80000019, 0}: {0xF0406020, 0x82005100},
+	})
+	full := "Fully associative"
+	want := TLBInfo{
+		Vendor: "AMD",
+		L1: TLBLevel{
+			Data:        []TLBEntry{{"2MB/4MB", 64, full}, {"4KB", 64, full}, {"1GB", 64, full}},
+			Instruction: []TLBEntry{{"2MB/4MB", 64, full}, {"4KB", 64, full}, {"1GB", 32, "8-way"}},
+		},
+		L2: TLBLevel{
+			Data:        []TLBEntry{{"2MB/4MB", 2048, "4-way"}, {"4KB", 2048, "8-way"}, {"1GB", 512, "16-way"}},
+			Instruction: []TLBEntry{{"2MB/4MB", 512, "2-way"}, {"4KB", 512, "4-way"}, {"1GB", 256, "6-way"}},
+		},
+	}
+	if got := amdTLBInfo(0x80000020, get); !reflect.DeepEqual(got, want) {
+		t.Errorf("amdTLBInfo =\n%+v\nwant\n%+v", got, want)
+	}
+
+	// Without 0x80000019 the 1GB entries are missing, without 0x80000006 the L2 TLBs too.
+	want.L1.Data, want.L1.Instruction = want.L1.Data[:2], want.L1.Instruction[:2]
+	want.L2.Data, want.L2.Instruction = want.L2.Data[:2], want.L2.Instruction[:2]
+	if got := amdTLBInfo(0x80000018, get); !reflect.DeepEqual(got, want) {
+		t.Errorf("amdTLBInfo without 0x80000019 =\n%+v\nwant\n%+v", got, want)
+	}
+	want.L2 = TLBLevel{}
+	if got := amdTLBInfo(0x80000005, get); !reflect.DeepEqual(got, want) {
+		t.Errorf("amdTLBInfo without 0x80000006 =\n%+v\nwant\n%+v", got, want)
+	}
+}
+
+func TestAMDAssociativity(t *testing.T) {
+	for _, tc := range []struct {
+		value     uint32
+		l1, coded string
+	}{
+		{0, "Reserved", "Reserved"},
+		{1, "1-way (direct mapped)", "1-way (direct mapped)"},
+		{2, "2-way", "2-way"},
+		{5, "5-way", "6-way"},
+		{6, "6-way", "8-way"},
+		{7, "7-way", "Reserved"},
+		{8, "8-way", "16-way"},
+		{0xA, "10-way", "32-way"},
+		{0xE, "14-way", "128-way"},
+		{0xF, "15-way", "Fully associative"},
+		{0x40, "64-way", "Reserved"},
+		{0xFF, "Fully associative", "Reserved"},
+	} {
+		if got := amdL1Associativity(tc.value); got != tc.l1 {
+			t.Errorf("amdL1Associativity(0x%X) = %q, want %q", tc.value, got, tc.l1)
+		}
+		if got := getAMDAssociativity(tc.value); got != tc.coded {
+			t.Errorf("getAMDAssociativity(0x%X) = %q, want %q", tc.value, got, tc.coded)
+		}
+	}
+}
+
+func TestIntelTLBInfo(t *testing.T) {
+	// Leaf 2 as a Skylake part reports it: descriptor 0x03 is the 64-entry 4K data TLB, the
+	// others are not TLB descriptors this decoder knows. The leaf 0x18 subleaves are encoded
+	// from the SDM layout: an instruction TLB, load-only and fully associative store-only data
+	// TLBs, an invalid subleaf and a unified L2 TLB.
+	regs := map[[2]uint32][4]uint32{
+		{0x2, 0}:  {0x76036301, 0x00FF0000, 0x00000000, 0x00C30000},
+		{0x18, 0}: {4, 8<<16 | 0x7, 16, 2 | 1<<5},
+		{0x18, 1}: {0, 4<<16 | 0x1, 16, 4 | 1<<5},
+		{0x18, 2}: {0, 16<<16 | 0xF, 1, 5 | 1<<5 | 1<<8},
+		{0x18, 4}: {0, 8<<16 | 0x3, 128, 3 | 2<<5},
+		{0x18, 5}: {0, 8<<16 | 0x1, 16, 1 | 1<<5}, // beyond the highest subleaf
+	}
+	want := TLBInfo{
+		Vendor: "Intel",
+		L1: TLBLevel{
+			Data: []TLBEntry{
+				{"4KB", 64, "4-way"},
+				{"4KB", 64, "4-way"},
+				{"4KB/2MB/4MB/1GB", 16, "Fully associative"},
+			},
+			Instruction: []TLBEntry{{"4KB/2MB/4MB", 128, "8-way"}},
+		},
+		L2: TLBLevel{Unified: []TLBEntry{{"4KB/2MB", 1024, "8-way"}}},
+	}
+	if got := intelTLBInfo(0x20, leafGetter(regs)); !reflect.DeepEqual(got, want) {
+		t.Errorf("intelTLBInfo =\n%+v\nwant\n%+v", got, want)
+	}
+
+	// Below leaf 0x18 only the descriptors are decoded.
+	want.L1 = TLBLevel{Data: want.L1.Data[:1]}
+	want.L2 = TLBLevel{}
+	if got := intelTLBInfo(0x17, leafGetter(regs)); !reflect.DeepEqual(got, want) {
+		t.Errorf("intelTLBInfo without leaf 0x18 =\n%+v\nwant\n%+v", got, want)
+	}
+
+	// A register with bit 31 set holds no descriptors, and AL is the iteration count.
+	regs[[2]uint32{0x2, 0}] = [4]uint32{0x00000001, 0x80000003, 0, 0x00000300}
+	want.L1.Data = []TLBEntry{{"4KB", 64, "4-way"}}
+	if got := intelTLBInfo(0x17, leafGetter(regs)); !reflect.DeepEqual(got, want) {
+		t.Errorf("intelTLBInfo with an invalid register =\n%+v\nwant\n%+v", got, want)
+	}
+}
@@ -0,0 +1,401 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"errors"
+	"math/bits"
+)
+
+// TopologyLevel is a level of the CPU hierarchy, ordered from a logical CPU up to the package.
+type TopologyLevel uint8
+
+// Topology levels. Module, tile and die group are only enumerated by Intel leaf 0x1F,
+// the core complex only by AMD leaf 0x80000026 (or derived from the L3 sharing on older AMD parts).
+const (
+	LevelThread   TopologyLevel = iota // a logical CPU (SMT thread)
+	LevelCore                          // a physical core
+	LevelModule                        // Intel module
+	LevelTile                          // Intel tile
+	LevelComplex                       // AMD core complex (CCX)
+	LevelDie                           // Intel die or AMD core complex die (CCD) / node
+	LevelDieGroup                      // Intel die group
+	LevelPackage                       // a physical package (socket)
+	numTopologyLevels
+)
+
+var topologyLevelNames = [numTopologyLevels]string{
+	LevelThread:   "Thread",
+	LevelCore:     "Core",
+	LevelModule:   "Module",
+	LevelTile:     "Tile",
+	LevelComplex:  "Complex",
+	LevelDie:      "Die",
+	LevelDieGroup: "DieGroup",
+	LevelPackage:  "Package",
+}
+
+// String returns the level name.
+func (l TopologyLevel) String() string {
+	if l < numTopologyLevels {
+		return topologyLevelNames[l]
+	}
+	return "Unknown"
+}
+
+// intelTopologyLevels maps the level types of leaves 0xB and 0x1F (ECX[15:8]) to a TopologyLevel.
+var intelTopologyLevels = [...]TopologyLevel{1: LevelThread, 2: LevelCore, 3: LevelModule, 4: LevelTile, 5: LevelDie, 6: LevelDieGroup}
+
+// amdTopologyLevels maps the level types of leaf 0x80000026 (ECX[15:8]: core, complex, die, socket)
+// to the TopologyLevel of the units they count, so they read the same way as the Intel levels.
+var amdTopologyLevels = [...]TopologyLevel{1: LevelThread, 2: LevelCore, 3: LevelComplex, 4: LevelDie}
+
+// TopologyShifts holds the number of low x2APIC ID bits below each level:
+// the ID of the unit a logical CPU belongs to at level l is APICID >> shifts[l].
+// A level the CPU does not enumerate has the shift of the level below it (each unit holds a single
+// unit of the lower level), except die and die group, which default to the whole package.
+type TopologyShifts [numTopologyLevels]uint32
+
+// CPUTopology places one logical CPU in the hierarchy.
+// IDs are derived from the x2APIC ID, so Core and Die are unique across the whole system,
+// not just within their package.
+type CPUTopology struct {
+	CPU      int    // Linux CPU number
+	APICID   uint32 // x2APIC ID (or the 8-bit initial APIC ID on CPUs without leaf 0xB)
+	Package  uint32
+	Die      uint32
+	Core     uint32
+	Thread   uint32 // SMT thread within the core
+	CoreType uint8  // hybrid core type from leaf 0x1A (0x20 Atom, 0x40 Core), 0 if not hybrid
+
+	ids      [numTopologyLevels]uint32
+	siblings [numTopologyLevels][]int
+}
+
+// ID returns the ID of the unit the CPU belongs to at the given level.
+func (c *CPUTopology) ID(level TopologyLevel) uint32 {
+	if level >= numTopologyLevels {
+		return 0
+	}
+	return c.ids[level]
+}
+
+// Topology maps every logical CPU to its package, die, core and thread.
+type Topology struct {
+	Shifts TopologyShifts // level widths of the lowest numbered CPU
+	CPUs   []CPUTopology  // sorted by CPU number
+
+	pos    []int32 // CPU number -> index into CPUs, -1 if absent
+	groups [numTopologyLevels][][]int
+}
+
+var errNoTopology = errors.New("no CPU data to build the topology from")
+
+// NewTopology builds the topology from a per-CPU capture (see CapturePerCPU and PerCPUFromData).
+func NewTopology(cpus CPUSnapshots) *Topology {
+	nums := cpus.CPUs()
+	srcs := make([]leafSource, len(nums))
+	for i, cpu := range nums {
+		srcs[i] = cpus[cpu]
+	}
+	return newTopology(nums, srcs)
+}
+
+func newTopology(nums []int, srcs []leafSource) *Topology {
+	t := &Topology{CPUs: make([]CPUTopology, len(nums))}
+	if len(nums) == 0 {
+		return t
+	}
+
+	t.pos = make([]int32, nums[len(nums)-1]+1)
+	for i := range t.pos {
+		t.pos[i] = -1
+	}
+
+	var units [numTopologyLevels]map[uint32][]int
+	for l := range units {
+		units[l] = map[uint32][]int{}
+	}
+	for i, cpu := range nums {
+		shifts, apicID, coreType := decodeTopology(srcs[i])
+		if i == 0 {
+			t.Shifts = shifts
+		}
+
+		c := &t.CPUs[i]
+		c.CPU, c.APICID, c.CoreType = cpu, apicID, coreType
+		for l := range c.ids {
+			c.ids[l] = apicID >> shifts[l]
+			units[l][c.ids[l]] = append(units[l][c.ids[l]], cpu)
+		}
+		c.Package, c.Die, c.Core = c.ids[LevelPackage], c.ids[LevelDie], c.ids[LevelCore]
+		c.Thread = apicID & (1<<shifts[LevelCore] - 1)
+		t.pos[cpu] = int32(i)
+	}
+
+	// CPUs are visited in ascending order, so every sibling list is sorted and the
+	// units of a level are ordered by their first CPU.
+	for l := range units {
+		for i := range t.CPUs {
+			c := &t.CPUs[i]
+			c.siblings[l] = units[l][c.ids[l]]
+			if c.siblings[l][0] == c.CPU {
+				t.groups[l] = append(t.groups[l], c.siblings[l])
+			}
+		}
+	}
+	return t
+}
+
+// CPU returns the placement of a CPU and whether it is part of the topology.
+func (t *Topology) CPU(cpu int) (CPUTopology, bool) {
+	if cpu < 0 || cpu >= len(t.pos) || t.pos[cpu] < 0 {
+		return CPUTopology{}, false
+	}
+	return t.CPUs[t.pos[cpu]], true
+}
+
+// Siblings returns the CPUs that share the given CPU's unit at a level, in ascending order and
+// including cpu itself: LevelCore gives its SMT siblings, LevelDie the CPUs on the same die.
+// The lookup is O(1); the returned slice is shared and must not be modified.
+func (t *Topology) Siblings(cpu int, level TopologyLevel) []int {
+	if cpu < 0 || cpu >= len(t.pos) || t.pos[cpu] < 0 || level >= numTopologyLevels {
+		return nil
+	}
+	return t.CPUs[t.pos[cpu]].siblings[level]
+}
+
+// Groups returns the CPUs of every unit at a level (one list per core, die, package, ...),
+// ordered by their lowest CPU. The returned slices are shared and must not be modified.
+func (t *Topology) Groups(level TopologyLevel) [][]int {
+	if level >= numTopologyLevels {
+		return nil
+	}
+	return t.groups[level]
+}
+
+// Count returns the number of units at a level, e.g. Count(LevelCore) is the number of physical cores.
+func (t *Topology) Count(level TopologyLevel) int {
+	return len(t.Groups(level))
+}
+
+// GetTopology returns the topology of the data source. Live, it captures every online CPU with
+// CapturePerCPU (Linux only). Offline, it uses the per-CPU data of the dump, or treats a dump
+// without any as a single CPU 0. The result is built once per data source and cached with it.
+func GetTopology(offline bool, filename string) (*Topology, error) {
+	d, nums, srcs, err := perCPUSources(offline, filename)
+	if err != nil {
+		return nil, err
+	}
+	d.topologyOnce.Do(func() {
+		d.topology = newTopology(nums, srcs)
+	})
+	return d.topology, nil
+}
+
+// perCPUSources returns the CPU numbers and per-CPU results of the data source together with
+// its derived values. The live per-CPU capture runs once per live snapshot.
+func perCPUSources(offline bool, filename string) (*derived, []int, []leafSource, error) {
+	d := derivedFor(offline, filename)
+	if d == nil {
+		_, err := loadOffline(filename)
+		return nil, nil, nil, err
+	}
+	d.cpusOnce.Do(func() {
+		var cpus CPUSnapshots
+		if offline {
+			f, err := loadOffline(filename)
+			if err != nil {
+				d.cpusErr = err
+				return
+			}
+			if f.perCPU == nil {
+				d.cpuNums, d.cpuSrcs = []int{0}, []leafSource{f.src}
+				return
+			}
+			cpus = f.perCPU
+		} else if cpus, d.cpusErr = CapturePerCPU(); d.cpusErr != nil {
+			return
+		}
+		if len(cpus) == 0 {
+			d.cpusErr = errNoTopology
+			return
+		}
+		d.cpuNums = cpus.CPUs()
+		for _, cpu := range d.cpuNums {
+			d.cpuSrcs = append(d.cpuSrcs, cpus[cpu])
+		}
+	})
+	return d, d.cpuNums, d.cpuSrcs, d.cpusErr
+}
+
+// decodeTopology decodes the x2APIC level widths, the APIC ID and the hybrid core type
+// from the CPUID results of one logical CPU.
+func decodeTopology(src leafSource) (shifts TopologyShifts, apicID uint32, coreType uint8) {
+	get := sourceGetter(src)
+	maxStd, vb, vc, vd := get(0, 0)
+	vendor := vendorFromRegisters(vb, vc, vd)
+	maxExt, _, _, _ := get(0x80000000, 0)
+
+	hasLeaf := func(leaf uint32) bool {
+		if leaf >= 0x80000000 {
+			if maxExt < leaf {
+				return false
+			}
+		} else if maxStd < leaf {
+			return false
+		}
+		// A topology leaf is valid if its first level counts at least one logical CPU.
+		_, b, _, _ := get(leaf, 0)
+		return b&0xFFFF != 0
+	}
+
+	var known [numTopologyLevels]bool
+	known[LevelThread] = true
+
+	switch {
+	case vendor.AMDCompatible() && hasLeaf(0x80000026):
+		walkTopologyLeaf(get, 0x80000026, amdTopologyLevels[:], &shifts, &known)
+		_, _, _, apicID = get(0x80000026, 0)
+	case hasLeaf(0x1F):
+		walkTopologyLeaf(get, 0x1F, intelTopologyLevels[:], &shifts, &known)
+		_, _, _, apicID = get(0x1F, 0)
+	case hasLeaf(0xB):
+		walkTopologyLeaf(get, 0xB, intelTopologyLevels[:], &shifts, &known)
+		_, _, _, apicID = get(0xB, 0)
+	default:
+		legacyTopologyShifts(get, vendor, maxStd, maxExt, &shifts, &known)
+		_, b, _, _ := get(1, 0)
+		apicID = b >> 24
+		if vendor.AMDCompatible() && maxExt >= 0x8000001E {
+			apicID, _, _, _ = get(0x8000001E, 0)
+		}
+	}
+
+	if vendor.AMDCompatible() && !known[LevelComplex] {
+		amdComplexAndNodeShifts(get, maxExt, &shifts, &known)
+	}
+
+	// Levels that are not enumerated collapse onto the level below them,
+	// except dies and die groups, which span the package.
+	for l := LevelCore; l < LevelDie; l++ {
+		if !known[l] {
+			shifts[l] = shifts[l-1]
+		}
+	}
+	for l := LevelDieGroup; l >= LevelDie; l-- {
+		if !known[l] {
+			shifts[l] = shifts[l+1]
+		}
+	}
+	// Keep the widths monotonic even for inconsistent data.
+	for l := LevelCore; l < numTopologyLevels; l++ {
+		if shifts[l] < shifts[l-1] {
+			shifts[l] = shifts[l-1]
+		}
+	}
+
+	if maxStd >= 0x1A {
+		a, _, _, _ := get(0x1A, 0)
+		coreType = uint8(a >> 24)
+	}
+	return shifts, apicID, coreType
+}
+
+// walkTopologyLeaf reads the levels of an extended topology leaf (0xB, 0x1F or 0x80000026).
+// Each subleaf describes one level; its EAX[4:0] is the shift that yields the ID of the next
+// enumerated level, or of the package for the last one.
+func walkTopologyLeaf(get func(leaf, subleaf uint32) (a, b, c, d uint32), leaf uint32,
+	levels []TopologyLevel, shifts *TopologyShifts, known *[numTopologyLevels]bool) {
+	var prev TopologyLevel
+	var prevShift uint32
+	forEachSubleaf(leaf, get, func(subleaf, a, _, c, _ uint32) bool {
+		levelType := (c >> 8) & 0xFF
+		if levelType == 0 || int(levelType) >= len(levels) {
+			return false
+		}
+		level := levels[levelType]
+		if subleaf > 0 {
+			if level <= prev {
+				return false
+			}
+			shifts[level], known[level] = prevShift, true
+		}
+		prev, prevShift = level, a&0x1F
+		return true
+	})
+	shifts[LevelPackage], known[LevelPackage] = prevShift, true
+}
+
+// legacyTopologyShifts derives the SMT and package widths on CPUs without an extended topology leaf:
+// from the logical and core counts of leaves 1 and 4 on Intel, and from 0x80000008 and 0x8000001E on AMD.
+func legacyTopologyShifts(get func(leaf, subleaf uint32) (a, b, c, d uint32), vendor Vendor,
+	maxStd, maxExt uint32, shifts *TopologyShifts, known *[numTopologyLevels]bool) {
+	if maxStd < 1 {
+		return
+	}
+	_, b, _, d := get(1, 0)
+	logical := uint32(1)
+	if d&(1<<28) != 0 && (b>>16)&0xFF != 0 { // HTT: EBX[23:16] is valid
+		logical = (b >> 16) & 0xFF
+	}
+
+	switch {
+	case vendor.AMDCompatible() && maxExt >= 0x80000008:
+		_, _, c, _ := get(0x80000008, 0)
+		pkgBits := (c >> 12) & 0xF // ApicIdCoreIdSize
+		if pkgBits == 0 {
+			pkgBits = ceilLog2(c&0xFF + 1)
+		}
+		threadsPerCore := uint32(1)
+		if maxExt >= 0x8000001E {
+			_, b, _, _ := get(0x8000001E, 0)
+			threadsPerCore = (b>>8)&0xFF + 1
+		}
+		shifts[LevelCore], shifts[LevelPackage] = ceilLog2(threadsPerCore), pkgBits
+	case maxStd >= 4:
+		a, _, _, _ := get(4, 0)
+		cores := a>>26 + 1
+		if cores > logical {
+			cores = logical
+		}
+		shifts[LevelCore], shifts[LevelPackage] = ceilLog2(logical/cores), ceilLog2(logical)
+	default:
+		shifts[LevelCore], shifts[LevelPackage] = ceilLog2(logical), ceilLog2(logical)
+	}
+	known[LevelCore], known[LevelPackage] = true, true
+}
+
+// amdComplexAndNodeShifts fills in the AMD levels older parts do not enumerate: the core complex
+// from the CPUs sharing the L3 (0x8000001D) and the node (die) from the nodes per package (0x8000001E).
+func amdComplexAndNodeShifts(get func(leaf, subleaf uint32) (a, b, c, d uint32), maxExt uint32,
+	shifts *TopologyShifts, known *[numTopologyLevels]bool) {
+	if maxExt >= 0x8000001D {
+		forEachSubleaf(0x8000001D, get, func(_, a, _, _, _ uint32) bool {
+			if a&0x1F == 0 {
+				return false
+			}
+			if (a>>5)&0x7 == 3 {
+				if s := ceilLog2((a>>14)&0xFFF + 1); s > shifts[LevelCore] && s <= shifts[LevelPackage] {
+					shifts[LevelComplex], known[LevelComplex] = s, true
+				}
+				return false
+			}
+			return true
+		})
+	}
+
+	if maxExt >= 0x8000001E && !known[LevelDie] {
+		_, _, c, _ := get(0x8000001E, 0)
+		if nodes := (c>>8)&0x7 + 1; nodes > 1 && ceilLog2(nodes) <= shifts[LevelPackage] {
+			shifts[LevelDie], known[LevelDie] = shifts[LevelPackage]-ceilLog2(nodes), true
+		}
+	}
+}
+
+// ceilLog2 returns the number of bits needed to hold n distinct IDs.
+func ceilLog2(n uint32) uint32 {
+	if n <= 1 {
+		return 0
+	}
+	return uint32(bits.Len32(n - 1))
+}
@@ -0,0 +1,15 @@
+package cpuid
+
+import "testing"
+
+// TestLegacyTopologyZeroLogicalCount decodes a leaf 1 with HTT set but no logical processor
+// count, as a truncated or hand-written dump may, and with leaf 4 present.
+func TestLegacyTopologyZeroLogicalCount(t *testing.T) {
+	leaf0 := intelLeaf0
+	leaf0.EAX = 4
+	src := NewSnapshot([]Entry{leaf0, {Leaf: 1, EDX: 1 << 28}, {Leaf: 4}})
+	shifts, _, _ := decodeTopology(src)
+	if shifts[LevelCore] != 0 || shifts[LevelPackage] != 0 {
+		t.Errorf("shifts = %v, want a single CPU", shifts)
+	}
+}
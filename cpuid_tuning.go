@@ -0,0 +1,122 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import (
+	"errors"
+	"strings"
+)
+
+// Tuning holds working-set sizes derived from the cache and TLB hierarchy, in bytes,
+// for choosing tile and block sizes (GEMM panels, hash-join partitions, ...).
+//
+// The *Size fields are the capacity one core (L1d, L2) or one logical CPU (L3) gets: the cache
+// size divided by the number of cores or threads sharing it. The *Budget fields leave one way of
+// each cache free for the data streamed past the blocked working set (outputs, stack, code):
+// Budget = Size * (ways-1) / ways. Sharing counts come from CPUID (the logical processor IDs a
+// cache serves), not from the CPUs the OS has online, so values are the same for every host of
+// a model and may err small on parts with disabled cores.
+type Tuning struct {
+	LineSize       uint64 // L1 data cache line size
+	ThreadsPerCore uint64 // SMT width from the topology leaves
+
+	L1DSize     uint64
+	L1DBudget   uint64
+	L2Size      uint64 // per core; 0 if the CPU has no L2
+	L2Budget    uint64
+	L3PerThread uint64 // per logical CPU; 0 if the CPU has no L3
+	L3Budget    uint64
+
+	// FalseSharingPad is the padding or alignment that keeps independently written data out of
+	// each other's cache lines. It is two lines, because the adjacent-line (spatial) prefetchers
+	// of current x86 cores fetch lines in 128-byte aligned pairs.
+	FalseSharingPad uint64
+
+	// TLBReach4K and TLBReach2M are the bytes the largest data TLB level maps with 4K or 2M pages.
+	// Working sets above them pay page walks; 0 if the CPU does not report the TLB.
+	TLBReach4K uint64
+	TLBReach2M uint64
+}
+
+var errNoCacheInfo = errors.New("no cache information in CPUID")
+
+// GetTuning derives working-set sizes from GetCacheInfo, GetTLBInfo and the topology leaves of
+// the data source. It is deterministic for a dump, so tuning can be precomputed per host model.
+func GetTuning(offline bool, filename string) (Tuning, error) {
+	maxFunc, maxExtFunc := GetMaxFunctions(offline, filename)
+	caches, err := GetCacheInfo(maxFunc, maxExtFunc, "", offline, filename)
+	if err != nil {
+		return Tuning{}, err
+	}
+	if len(caches) == 0 {
+		return Tuning{}, errNoCacheInfo
+	}
+
+	var t Tuning
+	t.ThreadsPerCore = 1
+	if src := sourceFor(offline, filename); src != nil {
+		shifts, _, _ := decodeTopology(src)
+		t.ThreadsPerCore = 1 << shifts[LevelCore]
+	}
+
+	for _, c := range caches {
+		if c.Type == "Instruction" {
+			continue
+		}
+		size := uint64(c.SizeKB) * 1024
+		sharing := uint64(c.MaxCoresSharing)
+		if sharing == 0 {
+			sharing = 1
+		}
+		cores := sharing / t.ThreadsPerCore
+		if cores == 0 {
+			cores = 1
+		}
+
+		switch c.Level {
+		case 1:
+			t.LineSize = uint64(c.LineSizeBytes)
+			t.L1DSize = size
+			t.L1DBudget = wayBudget(size, c.Ways)
+		case 2:
+			t.L2Size = size / cores
+			t.L2Budget = wayBudget(t.L2Size, c.Ways)
+		case 3:
+			t.L3PerThread = size / sharing
+			t.L3Budget = wayBudget(t.L3PerThread, c.Ways)
+		}
+	}
+	if t.LineSize == 0 {
+		t.LineSize = 64
+	}
+	t.FalseSharingPad = 2 * t.LineSize
+
+	if tlb, err := GetTLBInfo(maxFunc, maxExtFunc, offline, filename); err == nil {
+		for _, level := range []TLBLevel{tlb.L1, tlb.L2, tlb.L3} {
+			for _, e := range append(level.Data, level.Unified...) {
+				if r := tlbReach(e, "4KB", 4<<10); r > t.TLBReach4K {
+					t.TLBReach4K = r
+				}
+				if r := tlbReach(e, "2MB", 2<<20); r > t.TLBReach2M {
+					t.TLBReach2M = r
+				}
+			}
+		}
+	}
+	return t, nil
+}
+
+// wayBudget leaves one way of a cache share free.
+func wayBudget(size uint64, ways uint32) uint64 {
+	if ways <= 1 {
+		return size
+	}
+	return size - size/uint64(ways)
+}
+
+// tlbReach returns the bytes a TLB maps with pages of the given size, or 0 if it does not hold them.
+func tlbReach(e TLBEntry, page string, pageSize uint64) uint64 {
+	if e.Entries <= 0 || !strings.Contains(e.PageSize, page) {
+		return 0
+	}
+	return uint64(e.Entries) * pageSize
+}
@@ -12,3 +12,28 @@ TEXT ·cpuid(SB), $0-24
     MOVL CX, c+16(FP)      // Store CX result into return variable 'c' (32-bit)
     MOVL DX, d+20(FP)      // Store DX result into return variable 'd' (32-bit)
     RET                    // Return from the function
+
+// func rdtsc() (lo, hi uint32)
+TEXT ·rdtsc(SB), $0-8
+    LFENCE                 // Wait for earlier instructions before reading the counter
+    RDTSC                  // Read the time-stamp counter into DX:AX
+    MOVL AX, lo+0(FP)
+    MOVL DX, hi+4(FP)
+    RET
+
+// func rdtscp() (lo, hi, aux uint32)
+TEXT ·rdtscp(SB), $0-12
+    RDTSCP                 // Read the counter once earlier instructions completed, TSC_AUX into CX
+    LFENCE                 // Keep later instructions from starting before the read
+    MOVL AX, lo+0(FP)
+    MOVL DX, hi+4(FP)
+    MOVL CX, aux+8(FP)
+    RET
+
+// func xgetbv0() (eax, edx uint32)
+TEXT ·xgetbv0(SB), $0-8
+    MOVL $0, CX            // XCR0
+    BYTE $0x0F; BYTE $0x01; BYTE $0xD0 // XGETBV
+    MOVL AX, eax+0(FP)
+    MOVL DX, edx+4(FP)
+    RET
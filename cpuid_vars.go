@@ -1,18 +1,14 @@
 package cpuid
 
-var (
-	extb uint32
-)
-
 // FeatureSet defines a group of CPU features and how to query them
 type FeatureSet struct {
-	name      string            // Display name
-	leaf      uint32            // CPUID leaf (eax input)
-	subleaf   uint32            // CPUID subleaf (ecx input)
-	register  int               // Which register to use (0=EAX, 1=EBX, 2=ECX, 3=EDX)
-	condition func(uint32) bool // Optional condition function
-	group     string            // Group name
-	features  map[int]Feature   // Feature map
+	name      string                                   // Display name
+	leaf      uint32                                   // CPUID leaf (eax input)
+	subleaf   uint32                                   // CPUID subleaf (ecx input)
+	register  int                                      // Which register to use (0=EAX, 1=EBX, 2=ECX, 3=EDX)
+	condition func(offline bool, filename string) bool // Optional condition function
+	group     string                                   // Group name
+	features  map[int]Feature                          // Feature map
 }
 
 // Feature represents a CPU feature with its description and function
@@ -245,7 +241,6 @@ var cpuFeaturesList = map[string]FeatureSet{
 			21: {"ENQCMD", "Enqueue Command", "CPUID.7.0:ECX.ENQCMD[bit 21]", "intel", "", -1},
 			22: {"UINTR", "User Interrupts", "CPUID.7.0:ECX.UINTR[bit 22]", "intel", "", -1},
 			23: {"TILE", "Tile computation on matrix", "CPUID.7.0:ECX.TILE[bit 23]", "intel", "", -1},
-			24: {"AMX_BF16", "AMX bfloat16 Support", "CPUID.7.0:ECX.AMX_BF16[bit 24]", "intel", "", -1},
 			25: {"SPEC_CTRL", "Speculation Control", "CPUID.7.0:ECX.SPEC_CTRL[bit 25]", "common", "", -1},
 			26: {"STIBP", "Single Thread Indirect Branch Predictors", "CPUID.7.0:ECX.STIBP[bit 26]", "common", "AMDExtendedECX", 17}, // equivalent to AMD's implementation of STIBP
 			27: {"L1D_FLUSH", "L1 Data Cache Flush", "CPUID.7.0:ECX.L1D_FLUSH[bit 27]", "common", "", -1},
@@ -260,7 +255,7 @@ var cpuFeaturesList = map[string]FeatureSet{
 		subleaf:   0,
 		register:  2,
 		group:     "AMD",
-		condition: func(f uint32) bool { return isAMD(false, "") },
+		condition: func(offline bool, filename string) bool { return GetVendor(offline, filename).AMDCompatible() },
 		features: map[int]Feature{
 			0:  {"LAHF_LM", "LAHF/SAHF in long mode", "CPUID.80000001H:ECX.LAHF_LM[bit 0]", "amd", "", -1},
 			1:  {"CMP_LEGACY", "Core multi-processing legacy mode", "CPUID.80000001H:ECX.CMP_LEGACY[bit 1]", "amd", "", -1},
@@ -332,7 +327,7 @@ var cpuFeaturesList = map[string]FeatureSet{
 		subleaf:   0,
 		register:  0,
 		group:     "Security",
-		condition: func(f uint32) bool { return (extb>>2)&1 == 1 }, // Checks if SGX is supported via CPUID.7:EBX[2]
+		condition: func(offline bool, filename string) bool { return (extendedEBX(offline, filename)>>2)&1 == 1 }, // Checks if SGX is supported via CPUID.7:EBX[2]
 		features: map[int]Feature{
 			0: {"SGX1", "SGX1 instruction set", "CPUID.12H:EAX.SGX1[bit 0]", "intel", "", -1},
 			1: {"SGX2", "SGX2 instruction set", "CPUID.12H:EAX.SGX2[bit 1]", "intel", "", -1},
@@ -356,7 +351,7 @@ var cpuFeaturesList = map[string]FeatureSet{
 		subleaf:   0,
 		register:  1,
 		group:     "Debugging",
-		condition: func(f uint32) bool { return (extb>>25)&1 == 1 }, // Checks Intel PT support via CPUID.7:EBX[25]
+		condition: func(offline bool, filename string) bool { return (extendedEBX(offline, filename)>>25)&1 == 1 }, // Checks Intel PT support via CPUID.7:EBX[25]
 		features: map[int]Feature{
 			0: {"PT_CR3_FILTERING", "CR3 filtering support", "CPUID.14H:EBX.CR3_FILTERING[bit 0]", "intel", "", -1},
 			1: {"PT_CONFIGURABLE_PSB", "Configurable PSB support", "CPUID.14H:EBX.CONFIGURABLE_PSB[bit 1]", "intel", "", -1},
@@ -639,7 +634,7 @@ var cpuFeaturesList = map[string]FeatureSet{
 		subleaf:   0,
 		register:  0,
 		group:     "Security",
-		condition: func(f uint32) bool { return (extb>>2)&1 == 1 },
+		condition: func(offline bool, filename string) bool { return (extendedEBX(offline, filename)>>2)&1 == 1 },
 		features: map[int]Feature{
 			0: {"SGX_LC", "SGX Launch Control", "CPUID.12H:EAX.SGX_LC[bit 0]", "intel", "", -1},
 			1: {"SGX_KEYS", "SGX Attestation Keys", "CPUID.12H:EAX.SGX_KEYS[bit 1]", "intel", "", -1},
@@ -661,17 +656,18 @@ var cpuFeaturesList = map[string]FeatureSet{
 		register: 3,
 		group:    "Instruction",
 		features: map[int]Feature{
-			0: {"AMX_BF16", "AMX BFloat16 Support", "CPUID.7:EDX.AMX_BF16[bit 0]", "intel", "", -1},
-			1: {"AMX_TILE", "AMX Tile Architecture", "CPUID.7:EDX.AMX_TILE[bit 1]", "intel", "", -1},
-			2: {"AMX_INT8", "AMX Int8 Support", "CPUID.7:EDX.AMX_INT8[bit 2]", "intel", "", -1},
-			3: {"AMX_FP16", "AMX FP16 Support", "CPUID.7:EDX.AMX_FP16[bit 3]", "intel", "", -1},
-			4: {"AMX_DPBUUD", "AMX DPBUUD Support", "CPUID.7:EDX.AMX_DPBUUD[bit 4]", "intel", "", -1},
-			5: {"AMX_DPBUUDS", "AMX DPBUUDS Support", "CPUID.7:EDX.AMX_DPBUUDS[bit 5]", "intel", "", -1},
-			6: {"AMX_DPBUUD_TILELOAD", "AMX DPBUUD Tileload", "CPUID.7:EDX.AMX_DPBUUD_TILELOAD[bit 6]", "intel", "", -1},
-			7: {"AMX_DPBUUDS_TILELOAD", "AMX DPBUUDS Tileload", "CPUID.7:EDX.AMX_DPBUUDS_TILELOAD[bit 7]", "intel", "", -1},
-			// AMD Matrix extensions
-			8: {"MAI", "Matrix Acceleration Instructions", "CPUID.8000001FH:EAX.MAI[bit 0]", "amd", "", -1},
-			9: {"MAIA", "Matrix Acceleration Instructions Advanced", "CPUID.8000001FH:EAX.MAIA[bit 1]", "amd", "", -1},
+			22: {"AMX_BF16", "AMX BFloat16 Support", "CPUID.7:EDX.AMX_BF16[bit 22]", "intel", "", -1},
+			24: {"AMX_TILE", "AMX Tile Architecture", "CPUID.7:EDX.AMX_TILE[bit 24]", "intel", "", -1},
+			25: {"AMX_INT8", "AMX Int8 Support", "CPUID.7:EDX.AMX_INT8[bit 25]", "intel", "", -1},
+		},
+	}, "ExtendedSubleaf1EAX": {
+		name:     "Structured Extended Features Subleaf 1 EAX",
+		leaf:     7,
+		subleaf:  1,
+		register: 0,
+		group:    "Instruction",
+		features: map[int]Feature{
+			21: {"AMX_FP16", "AMX FP16 Support", "CPUID.(7,1):EAX.AMX_FP16[bit 21]", "intel", "", -1},
 		},
 	}, "SMM": {
 		name:     "System Management Mode",
@@ -705,7 +701,6 @@ var cpuFeaturesList = map[string]FeatureSet{
 			2: {"FRED", "Flexible Return and Event Delivery", "CPUID.7:ECX.FRED[bit 2]", "intel", "", -1},
 			3: {"LKGS", "Load and Zero Segment Registers", "CPUID.7:ECX.LKGS[bit 3]", "intel", "", -1},
 			4: {"WRMSRNS", "Write MSR No Serializing", "CPUID.7:ECX.WRMSRNS[bit 4]", "intel", "", -1},
-			5: {"AMX_FP16", "AMX FP16 Instructions", "CPUID.7:ECX.AMX_FP16[bit 5]", "intel", "", -1},
 			6: {"HRESET_OPT", "Optimized History Reset", "CPUID.7:ECX.HRESET_OPT[bit 6]", "common", "", -1},
 			7: {"AVX_VNNI_INT16", "AVX VNNI 16-bit Integer", "CPUID.7:ECX.AVX_VNNI_INT16[bit 7]", "intel", "", -1},
 			// AMD specific real-time features
@@ -1234,9 +1229,6 @@ var cpuFeaturesList = map[string]FeatureSet{
 			0: {"AVX512_4VNNIW", "AVX512 Vector Neural Network Instructions Word variable precision", "CPUID.7:EDX.AVX512_4VNNIW[bit 2]", "intel", "", -1},
 			1: {"AVX512_4FMAPS", "AVX512 Multiply Accumulation Single precision", "CPUID.7:EDX.AVX512_4FMAPS[bit 3]", "intel", "", -1},
 			2: {"AVX512_VP2INTERSECT", "AVX512 Vector Pair Intersection", "CPUID.7:EDX.AVX512_VP2INTERSECT[bit 8]", "intel", "", -1},
-			3: {"AMX_BF16", "Advanced Matrix Extensions BF16", "CPUID.7:EDX.AMX_BF16[bit 22]", "intel", "", -1},
-			4: {"AMX_TILE", "Advanced Matrix Extensions Tile", "CPUID.7:EDX.AMX_TILE[bit 24]", "intel", "", -1},
-			5: {"AMX_INT8", "Advanced Matrix Extensions INT8", "CPUID.7:EDX.AMX_INT8[bit 25]", "intel", "", -1},
 			6: {"AVX_VNNI", "AVX Vector Neural Network Instructions", "CPUID.7:ECX.AVX_VNNI[bit 4]", "intel", "", -1},
 			7: {"AVX512_BF16", "AVX512 BFloat16 Instructions", "CPUID.7:EAX.AVX512_BF16[bit 5]", "intel", "", -1},
 			// AMD vector/matrix features
@@ -1615,5 +1607,74 @@ var cpuFeaturesList = map[string]FeatureSet{
 			10: {"VM_PERM_LEVELS", "VM Permission Levels", "CPUID.8000001F:EAX[bit 4]", "amd", "", -1},
 			11: {"VM_REG_PROT", "VM Register Protection", "CPUID.8000001F:EAX[bit 5]", "amd", "", -1},
 		},
+	}, "KVMFeatures": {
+		name:      "KVM Paravirtual Features",
+		leaf:      0x40000001,
+		subleaf:   0,
+		register:  0,
+		group:     "Hypervisor",
+		condition: func(offline bool, filename string) bool { return GetHypervisor(offline, filename) == HypervisorKVM },
+		features: map[int]Feature{
+			0:  {"KVM_FEATURE_CLOCKSOURCE", "kvmclock at the original MSRs", "CPUID.40000001H:EAX[bit 0]", "common", "", -1},
+			1:  {"KVM_FEATURE_NOP_IO_DELAY", "No delays needed on PIO operations", "CPUID.40000001H:EAX[bit 1]", "common", "", -1},
+			2:  {"KVM_FEATURE_MMU_OP", "Deprecated MMU operations hypercall", "CPUID.40000001H:EAX[bit 2]", "common", "", -1},
+			3:  {"KVM_FEATURE_CLOCKSOURCE2", "kvmclock at the new MSRs", "CPUID.40000001H:EAX[bit 3]", "common", "", -1},
+			4:  {"KVM_FEATURE_ASYNC_PF", "Asynchronous page faults", "CPUID.40000001H:EAX[bit 4]", "common", "", -1},
+			5:  {"KVM_FEATURE_STEAL_TIME", "Steal time accounting", "CPUID.40000001H:EAX[bit 5]", "common", "", -1},
+			6:  {"KVM_FEATURE_PV_EOI", "Paravirtual end of interrupt", "CPUID.40000001H:EAX[bit 6]", "common", "", -1},
+			7:  {"KVM_FEATURE_PV_UNHALT", "Paravirtual spinlock unhalt", "CPUID.40000001H:EAX[bit 7]", "common", "", -1},
+			9:  {"KVM_FEATURE_PV_TLB_FLUSH", "Paravirtual TLB flush", "CPUID.40000001H:EAX[bit 9]", "common", "", -1},
+			10: {"KVM_FEATURE_ASYNC_PF_VMEXIT", "Asynchronous page fault VM exits", "CPUID.40000001H:EAX[bit 10]", "common", "", -1},
+			11: {"KVM_FEATURE_PV_SEND_IPI", "Paravirtual send IPI", "CPUID.40000001H:EAX[bit 11]", "common", "", -1},
+			12: {"KVM_FEATURE_POLL_CONTROL", "Host-side halt polling control", "CPUID.40000001H:EAX[bit 12]", "common", "", -1},
+			13: {"KVM_FEATURE_PV_SCHED_YIELD", "Paravirtual sched yield", "CPUID.40000001H:EAX[bit 13]", "common", "", -1},
+			14: {"KVM_FEATURE_ASYNC_PF_INT", "Asynchronous page fault interrupt delivery", "CPUID.40000001H:EAX[bit 14]", "common", "", -1},
+			15: {"KVM_FEATURE_MSI_EXT_DEST_ID", "Extended destination ID in MSI", "CPUID.40000001H:EAX[bit 15]", "common", "", -1},
+			16: {"KVM_FEATURE_HC_MAP_GPA_RANGE", "MAP_GPA_RANGE hypercall", "CPUID.40000001H:EAX[bit 16]", "common", "", -1},
+			17: {"KVM_FEATURE_MIGRATION_CONTROL", "Migration control MSR", "CPUID.40000001H:EAX[bit 17]", "common", "", -1},
+			24: {"KVM_FEATURE_CLOCKSOURCE_STABLE_BIT", "kvmclock is stable (no per-CPU warps)", "CPUID.40000001H:EAX[bit 24]", "common", "", -1},
+		},
+	}, "HyperVFeatures": {
+		name:      "Hyper-V Partition Privileges",
+		leaf:      0x40000003,
+		subleaf:   0,
+		register:  0,
+		group:     "Hypervisor",
+		condition: hyperVCompatible,
+		features: map[int]Feature{
+			0:  {"HV_MSR_VP_RUNTIME_AVAILABLE", "Virtual processor run time MSR", "CPUID.40000003H:EAX[bit 0]", "common", "", -1},
+			1:  {"HV_MSR_TIME_REF_COUNT_AVAILABLE", "Partition reference counter MSR", "CPUID.40000003H:EAX[bit 1]", "common", "", -1},
+			2:  {"HV_MSR_SYNIC_AVAILABLE", "Synthetic interrupt controller MSRs", "CPUID.40000003H:EAX[bit 2]", "common", "", -1},
+			3:  {"HV_MSR_SYNTIMER_AVAILABLE", "Synthetic timer MSRs", "CPUID.40000003H:EAX[bit 3]", "common", "", -1},
+			4:  {"HV_MSR_APIC_ACCESS_AVAILABLE", "APIC access MSRs", "CPUID.40000003H:EAX[bit 4]", "common", "", -1},
+			5:  {"HV_MSR_HYPERCALL_AVAILABLE", "Hypercall MSRs", "CPUID.40000003H:EAX[bit 5]", "common", "", -1},
+			6:  {"HV_MSR_VP_INDEX_AVAILABLE", "Virtual processor index MSR", "CPUID.40000003H:EAX[bit 6]", "common", "", -1},
+			7:  {"HV_MSR_RESET_AVAILABLE", "Virtual system reset MSR", "CPUID.40000003H:EAX[bit 7]", "common", "", -1},
+			8:  {"HV_MSR_STAT_PAGES_AVAILABLE", "Statistics page MSRs", "CPUID.40000003H:EAX[bit 8]", "common", "", -1},
+			9:  {"HV_MSR_REFERENCE_TSC_AVAILABLE", "Partition reference TSC page", "CPUID.40000003H:EAX[bit 9]", "common", "", -1},
+			10: {"HV_MSR_GUEST_IDLE_AVAILABLE", "Guest idle MSR", "CPUID.40000003H:EAX[bit 10]", "common", "", -1},
+			11: {"HV_ACCESS_FREQUENCY_MSRS", "TSC and APIC frequency MSRs", "CPUID.40000003H:EAX[bit 11]", "common", "", -1},
+			12: {"HV_ACCESS_DEBUG_MSRS", "Debug MSRs", "CPUID.40000003H:EAX[bit 12]", "common", "", -1},
+			13: {"HV_ACCESS_REENLIGHTENMENT", "Reenlightenment controls", "CPUID.40000003H:EAX[bit 13]", "common", "", -1},
+			15: {"HV_ACCESS_TSC_INVARIANT", "Invariant TSC control", "CPUID.40000003H:EAX[bit 15]", "common", "", -1},
+		},
+	}, "TMULFeatures": {
+		name:      "AMX TMUL Features",
+		leaf:      0x1E,
+		subleaf:   1,
+		register:  0,
+		group:     "Instruction",
+		condition: hasTMULFeatureLeaf,
+		features: map[int]Feature{
+			0: {"AMX_INT8", "AMX int8 dot products", "CPUID.1EH.1:EAX.AMX-INT8[bit 0]", "intel", "", -1},
+			1: {"AMX_BF16", "AMX bfloat16 dot products", "CPUID.1EH.1:EAX.AMX-BF16[bit 1]", "intel", "", -1},
+			2: {"AMX_COMPLEX", "AMX complex FP16 matrix multiply", "CPUID.1EH.1:EAX.AMX-COMPLEX[bit 2]", "intel", "", -1},
+			3: {"AMX_FP16", "AMX FP16 dot products", "CPUID.1EH.1:EAX.AMX-FP16[bit 3]", "intel", "", -1},
+			4: {"AMX_FP8", "AMX FP8 dot products", "CPUID.1EH.1:EAX.AMX-FP8[bit 4]", "intel", "", -1},
+			5: {"AMX_TRANSPOSE", "AMX tile transpose loads", "CPUID.1EH.1:EAX.AMX-TRANSPOSE[bit 5]", "intel", "", -1},
+			6: {"AMX_TF32", "AMX TF32 matrix multiply", "CPUID.1EH.1:EAX.AMX-TF32[bit 6]", "intel", "", -1},
+			7: {"AMX_AVX512", "AMX tile to AVX-512 moves and conversions", "CPUID.1EH.1:EAX.AMX-AVX512[bit 7]", "intel", "", -1},
+			8: {"AMX_MOVRS", "AMX read-shared tile loads", "CPUID.1EH.1:EAX.AMX-MOVRS[bit 8]", "intel", "", -1},
+		},
 	},
 }
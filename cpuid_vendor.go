@@ -0,0 +1,125 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+// Vendor identifies the CPU vendor reported in CPUID leaf 0.
+type Vendor uint8
+
+// Known CPU vendors.
+const (
+	VendorUnknown Vendor = iota
+	VendorIntel
+	VendorAMD
+	VendorHygon
+	VendorZhaoxin
+	VendorVIA
+	VendorTransmeta
+	VendorCyrix
+	VendorNSC
+	VendorSiS
+	VendorRDC
+	VendorVortex
+	VendorHypervisor // a virtual CPU that reports its hypervisor signature as the vendor
+)
+
+var vendorNames = [...]string{
+	VendorUnknown:    "Unknown",
+	VendorIntel:      "Intel",
+	VendorAMD:        "AMD",
+	VendorHygon:      "Hygon",
+	VendorZhaoxin:    "Zhaoxin",
+	VendorVIA:        "VIA",
+	VendorTransmeta:  "Transmeta",
+	VendorCyrix:      "Cyrix",
+	VendorNSC:        "National Semiconductor",
+	VendorSiS:        "SiS",
+	VendorRDC:        "RDC",
+	VendorVortex:     "DM&P Vortex",
+	VendorHypervisor: "Hypervisor",
+}
+
+// vendorIDs maps the 12-byte leaf 0 vendor string (EBX, EDX, ECX) to a Vendor.
+var vendorIDs = map[[12]byte]Vendor{
+	vendorKey("GenuineIntel"):          VendorIntel,
+	vendorKey("GenuineIotel"):          VendorIntel, // seen on some early Intel parts with a bad fuse
+	vendorKey("AuthenticAMD"):          VendorAMD,
+	vendorKey("AMDisbetter!"):          VendorAMD, // early AMD K5 engineering samples
+	vendorKey("HygonGenuine"):          VendorHygon,
+	vendorKey("  Shanghai  "):          VendorZhaoxin,
+	vendorKey("CentaurHauls"):          VendorVIA,
+	vendorKey("VIA VIA VIA "):          VendorVIA,
+	vendorKey("GenuineTMx86"):          VendorTransmeta,
+	vendorKey("TransmetaCPU"):          VendorTransmeta,
+	vendorKey("CyrixInstead"):          VendorCyrix,
+	vendorKey("Geode by NSC"):          VendorNSC,
+	vendorKey("SiS SiS SiS "):          VendorSiS,
+	vendorKey("Genuine  RDC"):          VendorRDC,
+	vendorKey("Vortex86 SoC"):          VendorVortex,
+	vendorKey("KVMKVMKVM\x00\x00\x00"): VendorHypervisor,
+	vendorKey("Microsoft Hv"):          VendorHypervisor,
+	vendorKey("VMwareVMware"):          VendorHypervisor,
+	vendorKey("XenVMMXenVMM"):          VendorHypervisor,
+	vendorKey("TCGTCGTCGTCG"):          VendorHypervisor,
+	vendorKey(" lrpepyh  vr"):          VendorHypervisor,
+	vendorKey("bhyve bhyve "):          VendorHypervisor,
+	vendorKey("VirtualApple"):          VendorHypervisor,
+}
+
+func vendorKey(id string) [12]byte {
+	var k [12]byte
+	copy(k[:], id)
+	return k
+}
+
+// String returns the vendor name.
+func (v Vendor) String() string {
+	if int(v) < len(vendorNames) {
+		return vendorNames[v]
+	}
+	return vendorNames[VendorUnknown]
+}
+
+// AMDCompatible reports whether the vendor uses AMD's cache, TLB and topology leaves.
+func (v Vendor) AMDCompatible() bool {
+	return v == VendorAMD || v == VendorHygon
+}
+
+// IntelCompatible reports whether the vendor uses Intel's cache, TLB and topology leaves.
+func (v Vendor) IntelCompatible() bool {
+	return v == VendorIntel || v == VendorZhaoxin || v == VendorVIA
+}
+
+// VendorFromID returns the Vendor for a leaf 0 vendor ID string such as "GenuineIntel".
+func VendorFromID(vendorID string) Vendor {
+	if len(vendorID) != 12 {
+		return VendorUnknown
+	}
+	return vendorIDs[vendorKey(vendorID)]
+}
+
+// vendorFromRegisters returns the Vendor for the EBX, EDX, ECX registers of leaf 0.
+func vendorFromRegisters(b, c, d uint32) Vendor {
+	var k [12]byte
+	putRegister(k[0:], b)
+	putRegister(k[4:], d)
+	putRegister(k[8:], c)
+	return vendorIDs[k]
+}
+
+// putRegister stores a register in little-endian byte order, the order cpuid strings use.
+func putRegister(dst []byte, r uint32) {
+	dst[0], dst[1], dst[2], dst[3] = byte(r), byte(r>>8), byte(r>>16), byte(r>>24)
+}
+
+// GetVendor returns the CPU vendor. It is resolved once per data source
+// (the live snapshot or an offline file) and cached with it.
+func GetVendor(offline bool, filename string) Vendor {
+	d := derivedFor(offline, filename)
+	if d == nil {
+		return VendorUnknown
+	}
+	d.vendorOnce.Do(func() {
+		_, b, c, dx := CPUIDWithMode(0, 0, offline, filename)
+		d.vendor = vendorFromRegisters(b, c, dx)
+	})
+	return d.vendor
+}
@@ -0,0 +1,113 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import "math/bits"
+
+// xsaveLegacySize is the size of the legacy region (x87 and SSE state) plus the XSAVE header,
+// where the extended components start in both formats.
+const xsaveLegacySize = 512 + 64
+
+// XSaveComponent describes one state component of the XSAVE area, from leaf 0xD subleaf Index.
+type XSaveComponent struct {
+	Index      uint   // bit of the component in XCR0 / IA32_XSS
+	Size       uint32 // EAX
+	Offset     uint32 // EBX, offset in the standard (non-compacted) format; 0 for supervisor components
+	Supervisor bool   // ECX[0], managed through IA32_XSS rather than XCR0
+	Aligned    bool   // ECX[1], starts on a 64-byte boundary in the compacted format
+	Enabled    bool   // set in XCR0
+}
+
+// XSaveLayout describes the XSAVE area: its components and the save area sizes for the state
+// components the OS enabled in XCR0.
+type XSaveLayout struct {
+	XCR0       uint64 // enabled user state components, see GetXCR0
+	Supported  uint64 // user state components the CPU supports, 0xD.0 EDX:EAX
+	Compacted  bool   // XSAVEC (compacted format) is supported, 0xD.1 EAX[1]
+	Components []XSaveComponent
+
+	StandardSize    uint32 // XSAVE/XSAVEOPT area for XCR0
+	MaxStandardSize uint32 // XSAVE area if every supported user component were enabled, 0xD.0 ECX
+	CompactedSize   uint32 // XSAVEC area for XCR0, 0 without XSAVEC
+}
+
+// Component returns the component with the given XCR0 bit, or false if the CPU does not support it.
+func (l XSaveLayout) Component(index uint) (XSaveComponent, bool) {
+	for _, c := range l.Components {
+		if c.Index == index {
+			return c, true
+		}
+	}
+	return XSaveComponent{}, false
+}
+
+// Sizes returns the standard and compacted save area sizes for a subset of the user state
+// components, e.g. the requested-feature bitmap passed to XSAVE/XSAVEC. Bits 0 and 1 (x87, SSE)
+// live in the legacy region and never add to the size.
+func (l XSaveLayout) Sizes(mask uint64) (standard, compacted uint32) {
+	standard, compacted = xsaveLegacySize, xsaveLegacySize
+	for _, c := range l.Components {
+		if c.Index < 2 || c.Supervisor || mask&(1<<c.Index) == 0 {
+			continue
+		}
+		if end := c.Offset + c.Size; end > standard {
+			standard = end
+		}
+		if c.Aligned {
+			compacted = (compacted + 63) &^ 63
+		}
+		compacted += c.Size
+	}
+	if !l.Compacted {
+		compacted = 0
+	}
+	return standard, compacted
+}
+
+// GetXSaveLayout decodes the XSAVE state components from the subleaves of leaf 0xD and computes
+// the save area sizes for the components enabled in XCR0. A scheduler switching user contexts
+// can allocate exactly StandardSize (or CompactedSize with XSAVEC) bytes, 64-byte aligned, per
+// context. Offline dumps use the XCR0 estimate described at GetXCR0.
+func GetXSaveLayout(offline bool, filename string) XSaveLayout {
+	var l XSaveLayout
+	if maxStd, _, _, _ := CPUIDWithMode(0, 0, offline, filename); maxStd < 0xD {
+		return l
+	}
+	if _, _, c, _ := CPUIDWithMode(1, 0, offline, filename); c&(1<<26) == 0 { // CPUID.1:ECX.XSAVE
+		return l
+	}
+
+	a, _, c, d := CPUIDWithMode(0xD, 0, offline, filename)
+	l.Supported = uint64(d)<<32 | uint64(a)
+	l.MaxStandardSize = c
+	l.XCR0 = GetXCR0(offline, filename)
+	a1, _, c1, d1 := CPUIDWithMode(0xD, 1, offline, filename)
+	l.Compacted = a1&(1<<1) != 0
+	supervisor := uint64(d1)<<32 | uint64(c1)
+
+	// Components 0 and 1 have fixed places in the legacy region.
+	legacy := [2]XSaveComponent{{Index: 0, Size: 160, Offset: 0}, {Index: 1, Size: 256, Offset: 160}}
+	for _, comp := range legacy {
+		if l.Supported&(1<<comp.Index) != 0 {
+			comp.Enabled = l.XCR0&(1<<comp.Index) != 0
+			l.Components = append(l.Components, comp)
+		}
+	}
+	for all := (l.Supported | supervisor) &^ 3; all != 0; all &= all - 1 {
+		i := uint(bits.TrailingZeros64(all))
+		size, offset, ecx, _ := CPUIDWithMode(0xD, uint32(i), offline, filename)
+		if size == 0 {
+			continue
+		}
+		l.Components = append(l.Components, XSaveComponent{
+			Index:      i,
+			Size:       size,
+			Offset:     offset,
+			Supervisor: ecx&1 != 0,
+			Aligned:    ecx&(1<<1) != 0,
+			Enabled:    l.XCR0&(1<<i) != 0,
+		})
+	}
+
+	l.StandardSize, l.CompactedSize = l.Sizes(l.XCR0)
+	return l
+}
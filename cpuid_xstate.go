@@ -0,0 +1,128 @@
+// Package cpuid provides information about the CPU running the current program.
+package cpuid
+
+import "strings"
+
+// xgetbv0 reads XCR0. It faults unless CPUID.1:ECX.OSXSAVE is set.
+func xgetbv0() (eax, edx uint32)
+
+// XCR0 state component bits. The OS sets a bit once it saves and restores that register state
+// on context switches; instructions using the state fault (#UD) until it does.
+const (
+	XStateX87      = 1 << 0
+	XStateSSE      = 1 << 1  // XMM registers
+	XStateAVX      = 1 << 2  // upper halves of the YMM registers
+	XStateBNDRegs  = 1 << 3  // MPX bound registers
+	XStateBNDCSR   = 1 << 4  // MPX configuration and status
+	XStateOpmask   = 1 << 5  // AVX-512 k0-k7
+	XStateZMMHi256 = 1 << 6  // upper halves of ZMM0-15
+	XStateHi16ZMM  = 1 << 7  // ZMM16-31
+	XStatePKRU     = 1 << 9  // protection key rights register
+	XStateTileCfg  = 1 << 17 // AMX TILECFG
+	XStateTileData = 1 << 18 // AMX tile registers
+	XStateAPX      = 1 << 19 // APX extended GPRs
+)
+
+const (
+	osxsaveBit      = 1 << 27 // CPUID.1:ECX.OSXSAVE
+	xstateAVXMask   = XStateSSE | XStateAVX
+	xstateAVX512    = xstateAVXMask | XStateOpmask | XStateZMMHi256 | XStateHi16ZMM
+	xstateAMX       = XStateTileCfg | XStateTileData
+	xstateMPX       = XStateBNDRegs | XStateBNDCSR
+	vexFeatureNames = ",FMA,FMA4,F16C,XOP,VAES,VAES_128,VAES_256,VPCLMULQDQ," // VEX-encoded outside the AVX* names
+)
+
+// featureXState maps a FeatureID to the XCR0 bits its instructions need, 0 if none.
+var featureXState []uint64
+
+// xstateRequired returns the XCR0 bits a feature's instructions need. Names describing state
+// components themselves (XSAVE_*, *_STATE, TILECFG, ...) only enumerate support and need none.
+func xstateRequired(name string) uint64 {
+	switch {
+	case strings.HasPrefix(name, "XSAVE_"), strings.HasSuffix(name, "_STATE"):
+		return 0
+	case strings.HasPrefix(name, "AVX512"), strings.HasPrefix(name, "AVX10"):
+		return xstateAVX512
+	case strings.HasPrefix(name, "AVX"), strings.Contains(vexFeatureNames, ","+name+","):
+		return xstateAVXMask
+	case name == "AMX_AVX512":
+		return xstateAMX | xstateAVX512
+	case strings.HasPrefix(name, "AMX_"):
+		return xstateAMX
+	case name == "MPX":
+		return xstateMPX
+	case name == "APX_F":
+		return XStateAPX
+	}
+	return 0
+}
+
+// GetXCR0 returns the state components enabled by the OS in XCR0, or 0 if the OS has not
+// enabled XSAVE (CPUID.1:ECX.OSXSAVE clear).
+// Offline dumps do not contain XCR0; they report the components of CPUID.(EAX=0DH,ECX=0):EDX:EAX,
+// which is what the OS of the capturing machine could enable, and usually did.
+func GetXCR0(offline bool, filename string) uint64 {
+	maxStd, _, _, _ := CPUIDWithMode(0, 0, offline, filename)
+	if maxStd < 1 {
+		return 0
+	}
+	if _, _, c, _ := CPUIDWithMode(1, 0, offline, filename); c&osxsaveBit == 0 {
+		return 0
+	}
+	if !offline {
+		lo, hi := xgetbv0()
+		return uint64(hi)<<32 | uint64(lo)
+	}
+	if maxStd < 0xD {
+		return XStateX87 | XStateSSE
+	}
+	a, _, _, d := CPUIDWithMode(0xD, 0, offline, filename)
+	return uint64(d)<<32 | uint64(a)
+}
+
+// GetUsableFeatureMask returns the features the CPU supports and the OS has enabled: those of
+// GetFeatureMask whose register state is set in XCR0. On Linux the AMX features additionally need
+// the process permission for the tile data state. The live mask requests it once (see
+// RequestAMXPermission), and only if the CPU supports AMX and XCR0 enables the tile data, since
+// the permission enlarges the signal frames of every thread.
+func GetUsableFeatureMask(offline bool, filename string) FeatureMask {
+	d := derivedFor(offline, filename)
+	if d == nil {
+		return FeatureMask{}
+	}
+	d.usableOnce.Do(func() {
+		d.usable = computeUsableMask(GetFeatureMask(offline, filename), GetXCR0(offline, filename), offline)
+	})
+	return d.usable
+}
+
+// requestAMXPermission is RequestAMXPermission, replaceable in tests.
+var requestAMXPermission = RequestAMXPermission
+
+func computeUsableMask(supported FeatureMask, xcr0 uint64, offline bool) FeatureMask {
+	amxChecked, amxAllowed := offline, offline
+	m := supported
+	for id, required := range featureXState {
+		if required == 0 || !m.Has(FeatureID(id)) {
+			continue
+		}
+		if xcr0&required == required && required&XStateTileData != 0 && !amxChecked {
+			amxChecked, amxAllowed = true, requestAMXPermission() == nil
+		}
+		if xcr0&required != required || (required&XStateTileData != 0 && !amxAllowed) {
+			m[id>>6] &^= 1 << (id & 63)
+		}
+	}
+	return m
+}
+
+// IsFeatureUsable reports if a feature is supported by the CPU and enabled by the OS, i.e. its
+// instructions can be executed without faulting. Use it instead of IsFeatureSupported before
+// running AVX, AVX-512 or AMX code.
+func IsFeatureUsable(featureName string, offline bool, filename string) bool {
+	id, ok := featureIDs[featureName]
+	if !ok {
+		return false
+	}
+	return GetUsableFeatureMask(offline, filename).Has(id)
+}
@@ -0,0 +1,44 @@
+package cpuid
+
+import (
+	"errors"
+	"testing"
+)
+
+// TestUsableMaskRequestsAMXOnlyWithAMX checks that computing the live usable mask asks for
+// the AMX permission only when the CPU has AMX and XCR0 enables the tile data.
+func TestUsableMaskRequestsAMXOnlyWithAMX(t *testing.T) {
+	defer func(f func() error) { requestAMXPermission = f }(requestAMXPermission)
+	requests := 0
+	var permErr error
+	requestAMXPermission = func() error {
+		requests++
+		return permErr
+	}
+
+	avx2, _ := FeatureMaskOf("AVX2")
+	amx, _ := FeatureMaskOf("AVX2", "AMX_TILE", "AMX_INT8")
+	xcr0 := uint64(XStateX87 | XStateSSE | XStateAVX)
+	for _, tc := range []struct {
+		name      string
+		supported FeatureMask
+		xcr0      uint64
+		permErr   error
+		requests  int
+		usable    []string
+	}{
+		{"no AMX", avx2, xcr0 | xstateAMX, nil, 0, []string{"AVX2"}},
+		{"tile data disabled", amx, xcr0, nil, 0, []string{"AVX2"}},
+		{"permission granted", amx, xcr0 | xstateAMX, nil, 1, []string{"AVX2", "AMX_TILE", "AMX_INT8"}},
+		{"permission denied", amx, xcr0 | xstateAMX, errors.New("denied"), 1, []string{"AVX2"}},
+	} {
+		requests, permErr = 0, tc.permErr
+		want, _ := FeatureMaskOf(tc.usable...)
+		if got := computeUsableMask(tc.supported, tc.xcr0, false); got != want {
+			t.Errorf("%s: usable %v, want %v", tc.name, got.Names(), want.Names())
+		}
+		if requests != tc.requests {
+			t.Errorf("%s: %d permission requests, want %d", tc.name, requests, tc.requests)
+		}
+	}
+}
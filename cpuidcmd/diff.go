@@ -0,0 +1,78 @@
+package main
+
+import (
+	"fmt"
+	"os"
+	"strings"
+
+	"github.com/earentir/cpuid"
+)
+
+// runDiff implements "cpuidcmd diff before after": it prints the differences between two dump
+// files and exits like diff(1), with 0 if they compare equal, 1 if they differ and 2 on errors.
+func runDiff(args []string) {
+	if len(args) != 2 {
+		fmt.Println("Usage: cpuidcmd diff BEFORE AFTER")
+		os.Exit(2)
+	}
+
+	d, err := cpuid.DiffFiles(args[0], args[1])
+	if err != nil {
+		fmt.Println("Error reading CPUID data:", err)
+		os.Exit(2)
+	}
+	if d.Empty() {
+		fmt.Println("No differences (per-CPU fields ignored).")
+		os.Exit(0)
+	}
+
+	regs := [4]string{"EAX", "EBX", "ECX", "EDX"}
+	fmt.Println("Changed Leaves")
+	fmt.Println("--------------")
+	for _, l := range d.Leaves {
+		fmt.Printf("  0x%08X.%d\n", l.Leaf, l.Subleaf)
+		for r, x := range l.Changed {
+			if x != 0 {
+				fmt.Printf("    %s  0x%08X -> 0x%08X  (xor 0x%08X)\n", regs[r], l.Before[r], l.After[r], x)
+			}
+		}
+	}
+	fmt.Println()
+
+	if len(d.Features) > 0 {
+		fmt.Println("Features")
+		fmt.Println("--------")
+		for _, f := range d.Features {
+			sign := "-"
+			if f.Added {
+				sign = "+"
+			}
+			fmt.Printf("  %s %-24s 0x%08X.%d %s[%d]\n", sign, f.Name, f.Leaf, f.Subleaf, regs[f.Register], f.Bit)
+		}
+		fmt.Println()
+	}
+
+	printDecodedChanges("Caches", d.Caches)
+	printDecodedChanges("TLBs", d.TLBs)
+	printDecodedChanges("Topology", d.Topology)
+	os.Exit(1)
+}
+
+func printDecodedChanges(title string, changes []cpuid.DecodedChange) {
+	if len(changes) == 0 {
+		return
+	}
+	fmt.Println(title)
+	fmt.Println(strings.Repeat("-", len(title)))
+	for _, c := range changes {
+		before, after := c.Before, c.After
+		if before == "" {
+			before = "(none)"
+		}
+		if after == "" {
+			after = "(none)"
+		}
+		fmt.Printf("  %s\n    - %s\n    + %s\n", c.Name, before, after)
+	}
+	fmt.Println()
+}
@@ -0,0 +1,86 @@
+package main
+
+import (
+	"fmt"
+	"os"
+	"strings"
+	"time"
+
+	"github.com/earentir/cpuid"
+)
+
+// buildFleetIndex indexes the dumps below dir and writes the index to indexFile.
+func buildFleetIndex(dir, indexFile string) {
+	start := time.Now()
+	x, err := cpuid.BuildFleetIndex(dir, 0)
+	if x == nil {
+		fmt.Println("Error building fleet index:", err)
+		os.Exit(1)
+	}
+	if err != nil {
+		fmt.Println("Skipped dumps:")
+		fmt.Println(err)
+	}
+	if err := x.WriteFile(indexFile); err != nil {
+		fmt.Println("Error writing fleet index:", err)
+		os.Exit(1)
+	}
+	fmt.Printf("Indexed %d hosts from %s into %s in %v.\n", x.Len(), dir, indexFile, time.Since(start).Round(time.Millisecond))
+}
+
+// queryFleetIndex prints the hosts of indexFile matching query (all hosts if empty),
+// or their histogram over the comma-separated columns in groupBy.
+func queryFleetIndex(indexFile, query, groupBy string) {
+	x, err := cpuid.LoadFleetIndex(indexFile)
+	if err != nil {
+		fmt.Println("Error reading fleet index:", err)
+		os.Exit(1)
+	}
+
+	start := time.Now()
+	set := x.All()
+	if query != "" {
+		if set, err = x.Query(query); err != nil {
+			fmt.Println("Error in query:", err)
+			os.Exit(1)
+		}
+	}
+	elapsed := time.Since(start)
+
+	if groupBy == "" {
+		for _, i := range set.Hosts() {
+			h := x.Host(i)
+			fmt.Printf("  %-32s %-8s family 0x%X model 0x%X stepping %d, L3 %d KB\n",
+				h.Name, h.Vendor, h.Family, h.Model, h.Stepping, h.L3KB)
+		}
+	} else {
+		columns := strings.Split(groupBy, ",")
+		groups, err := x.GroupBy(set, columns...)
+		if err != nil {
+			fmt.Println("Error grouping hosts:", err)
+			os.Exit(1)
+		}
+		widths := make([]int, len(columns))
+		for i, c := range columns {
+			widths[i] = len(c)
+			for _, g := range groups {
+				if len(g.Values[i]) > widths[i] {
+					widths[i] = len(g.Values[i])
+				}
+			}
+		}
+		fmt.Printf("  %8s", "Hosts")
+		for i, c := range columns {
+			fmt.Printf("  %-*s", widths[i], c)
+		}
+		fmt.Println()
+		for _, g := range groups {
+			fmt.Printf("  %8d", g.Count)
+			for i, v := range g.Values {
+				fmt.Printf("  %-*s", widths[i], v)
+			}
+			fmt.Println()
+		}
+	}
+	fmt.Printf("  %d of %d hosts matched in %v\n", set.Count(), x.Len(), elapsed)
+}
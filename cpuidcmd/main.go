@@ -2,6 +2,7 @@
 package main
 
 import (
+	"encoding/json"
 	"flag"
 	"fmt"
 	"os"
@@ -21,6 +22,26 @@ var (
 	hybrid                   bool
 	featurecategories        bool
 	featurecategoriesdetails bool
+	binaryFormat             bool
+	perCPU                   bool
+	topology                 bool
+	cacheDomains             bool
+	hypervisor               bool
+	xstate                   bool
+	amx                      bool
+	tuning                   bool
+	fingerprint              bool
+	profileLeaves            bool
+	profileIterations        int
+	profileJSON              bool
+	latency                  bool
+	latencyMaxMB             uint64
+	printStats               bool
+	convertTo                string
+	fleetBuild               string
+	fleetIndex               string
+	fleetQuery               string
+	fleetGroup               string
 )
 
 func init() {
@@ -29,19 +50,50 @@ func init() {
 }
 
 func main() {
+	if len(os.Args) > 1 && os.Args[1] == "diff" {
+		runDiff(os.Args[2:])
+	}
 
 	flag.BoolVar(&writeFlag, "write", false, "Capture CPUID data and write to file")
 	flag.BoolVar(&offlineData, "read", false, "Use offline mode (read CPUID data from file)")
 	flag.BoolVar(&cache, "cache", false, "Print cache information")
 	flag.BoolVar(&tlb, "tlb", false, "Print TLB information")
 	flag.BoolVar(&hybrid, "hybrid", false, "Print Intel Hybrid Core information")
+	flag.BoolVar(&topology, "topology", false, "Print the package/die/core/thread of every CPU")
+	flag.BoolVar(&cacheDomains, "cachedomains", false, "Print the CPUs sharing each cache instance")
+	flag.BoolVar(&hypervisor, "hypervisor", false, "Print the hypervisor leaves (signature, paravirtual features, TSC frequency)")
+	flag.BoolVar(&xstate, "xstate", false, "Print the OS-enabled state components (XCR0), the features they leave unusable and the XSAVE layout")
+	flag.BoolVar(&amx, "amx", false, "Print the AMX tile palettes and TMUL limits (leaves 0x1D/0x1E)")
+	flag.BoolVar(&tuning, "tuning", false, "Print working-set sizes derived from the caches and TLBs")
+	flag.BoolVar(&fingerprint, "fingerprint", false, "Print the fingerprint of the CPU model and its capabilities (per-CPU fields masked)")
 	flag.BoolVar(&featurecategories, "fcategories", false, "Print all available CPU feature categories")
 	flag.BoolVar(&featurecategoriesdetails, "fcategorieswithdetails", false, "Print all available CPU feature categories with details")
 
+	flag.BoolVar(&binaryFormat, "binary", false, "Write the captured CPUID data in the binary dump format")
+	flag.BoolVar(&perCPU, "percpu", false, "Capture CPUID data on every online CPU (Linux only)")
+	flag.StringVar(&convertTo, "convert", "", "Convert the dump given by -filename to this file (JSON to binary or binary to JSON)")
+
+	flag.BoolVar(&profileLeaves, "profile-leaves", false, "Measure the latency of every CPUID leaf on one pinned CPU")
+	flag.IntVar(&profileIterations, "profile-iterations", 1000, "Executions per leaf for -profile-leaves")
+	flag.BoolVar(&profileJSON, "profile-json", false, "Print the -profile-leaves or -latency result as JSON")
+	flag.BoolVar(&latency, "latency", false, "Measure cache and memory latency with a pointer chase and compare it with the reported caches")
+	flag.Uint64Var(&latencyMaxMB, "latency-max", 256, "Largest working set of the -latency sweep, in MB")
+
+	flag.StringVar(&fleetBuild, "fleet-build", "", "Index every dump below this directory into the -fleet-index file")
+	flag.StringVar(&fleetIndex, "fleet-index", "fleet.idx", "Fleet index file for -fleet-build and -fleet-query")
+	flag.StringVar(&fleetQuery, "fleet-query", "", "List the hosts of the fleet index matching this expression, e.g. \"AVX512F & !AVX512_VNNI\"")
+	flag.StringVar(&fleetGroup, "fleet-group", "", "Count the -fleet-query hosts by these comma-separated columns, e.g. \"model,l3_kb\"")
+
+	flag.BoolVar(&printStats, "stats", false, "Print the library's CPUID execution and lookup counters at the end")
+
 	flag.StringVar(&filename, "filename", "cpuid_data.json", "Set the filename for read/write operations")
 	flag.Parse()
 
 	if offlineData {
+		if _, err := cpuid.LoadSnapshot(filename); err != nil {
+			fmt.Println("Error reading CPUID data:", err)
+			os.Exit(1)
+		}
 		maxFunc, maxExtFunc = cpuid.GetMaxFunctions(offlineData, filename)
 		vendorID = cpuid.GetVendorID(offlineData, filename)
 	}
@@ -58,6 +110,34 @@ func main() {
 		os.Exit(0)
 	}
 
+	if profileLeaves {
+		printLeafProfile(profileIterations, profileJSON)
+		os.Exit(0)
+	}
+
+	if latency {
+		printLatencyProfile(latencyMaxMB<<20, profileJSON)
+		os.Exit(0)
+	}
+
+	if fleetBuild != "" {
+		buildFleetIndex(fleetBuild, fleetIndex)
+		os.Exit(0)
+	}
+
+	if fleetQuery != "" || fleetGroup != "" {
+		queryFleetIndex(fleetIndex, fleetQuery, fleetGroup)
+		os.Exit(0)
+	}
+
+	if convertTo != "" {
+		fmt.Println("Converting CPUID data")
+		fmt.Println("---------------------")
+		convertCPUIDFile(filename, convertTo)
+		fmt.Println()
+		os.Exit(0)
+	}
+
 	fmt.Println("offlineData:", offlineData)
 	fmt.Println("filename:", filename)
 	fmt.Println()
@@ -92,6 +172,55 @@ func main() {
 		fmt.Println()
 	}
 
+	if topology {
+		fmt.Println("CPU Topology")
+		fmt.Println("------------")
+		printTopology(offlineData, filename)
+		fmt.Println()
+	}
+
+	if cacheDomains {
+		fmt.Println("Cache Domains")
+		fmt.Println("-------------")
+		printCacheDomains(offlineData, filename)
+		fmt.Println()
+	}
+
+	if hypervisor {
+		fmt.Println("Hypervisor Info")
+		fmt.Println("---------------")
+		printHypervisorInfo(offlineData, filename)
+		fmt.Println()
+	}
+
+	if xstate {
+		fmt.Println("OS-Enabled State")
+		fmt.Println("----------------")
+		printXState(offlineData, filename)
+		fmt.Println()
+	}
+
+	if amx {
+		fmt.Println("AMX Info")
+		fmt.Println("--------")
+		printAMXInfo(offlineData, filename)
+		fmt.Println()
+	}
+
+	if tuning {
+		fmt.Println("Tuning")
+		fmt.Println("------")
+		printTuning(offlineData, filename)
+		fmt.Println()
+	}
+
+	if fingerprint {
+		fmt.Println("Fingerprint")
+		fmt.Println("-----------")
+		fmt.Printf("  %s\n", cpuid.GetFingerprint(offlineData, filename))
+		fmt.Println()
+	}
+
 	if featurecategories {
 		fmt.Println("All Available CPU Feature Categories")
 		fmt.Println("------------------------------------")
@@ -130,9 +259,35 @@ func main() {
 	fmt.Println("---------------------------------------")
 	fmt.Println(checkEnoughCores(8, true, offlineData, filename))
 	fmt.Println()
+
+	if printStats {
+		fmt.Println("Library Counters")
+		fmt.Println("----------------")
+		out, _ := json.MarshalIndent(cpuid.Stats(), "", "  ")
+		fmt.Println(string(out))
+		fmt.Println()
+	}
 }
 
 func writeCPUIDToFile() {
+	if perCPU {
+		if err := cpuid.CaptureDataPerCPU(filename); err != nil {
+			fmt.Println("Error capturing CPUID data:", err)
+			return
+		}
+		fmt.Printf("Per-CPU CPUID data captured successfully and written to %s.\n", filename)
+		return
+	}
+
+	if binaryFormat {
+		if err := cpuid.CaptureDataBinary(filename); err != nil {
+			fmt.Println("Error capturing CPUID data:", err)
+			return
+		}
+		fmt.Printf("CPUID data captured successfully and written to %s.\n", filename)
+		return
+	}
+
 	if err := cpuid.CaptureData("cpuid_data.json"); err != nil {
 		fmt.Println("Error capturing CPUID data:", err)
 		return
@@ -140,6 +295,20 @@ func writeCPUIDToFile() {
 	fmt.Println("CPUID data captured successfully and written to cpuid_data.json.")
 }
 
+func convertCPUIDFile(src, dst string) {
+	var err error
+	if cpuid.IsBinaryDump(src) {
+		err = cpuid.ConvertBinaryToJSON(src, dst)
+	} else {
+		err = cpuid.ConvertJSONToBinary(src, dst)
+	}
+	if err != nil {
+		fmt.Println("Error converting CPUID data:", err)
+		return
+	}
+	fmt.Printf("CPUID data converted from %s to %s.\n", src, dst)
+}
+
 func printBasicInfo() {
 	processorInfo := cpuid.GetProcessorInfo(maxFunc, maxExtFunc, offlineData, filename)
 	processorModel := cpuid.GetModelData(offlineData, filename)
@@ -269,6 +438,168 @@ func printIntelHybridInfo(offline bool, filename string) {
 	}
 }
 
+func printTopology(offline bool, filename string) {
+	topo, err := cpuid.GetTopology(offline, filename)
+	if err != nil {
+		fmt.Println("Error getting topology:", err)
+		return
+	}
+
+	fmt.Printf("  Packages: %d, Dies: %d, Cores: %d, Threads: %d\n",
+		topo.Count(cpuid.LevelPackage), topo.Count(cpuid.LevelDie), topo.Count(cpuid.LevelCore), len(topo.CPUs))
+	fmt.Printf("  %4s %8s %8s %6s %6s %7s  %s\n", "CPU", "APIC ID", "Package", "Die", "Core", "Thread", "SMT Siblings")
+	for _, c := range topo.CPUs {
+		fmt.Printf("  %4d %8d %8d %6d %6d %7d  %v\n", c.CPU, c.APICID, c.Package, c.Die, c.Core, c.Thread,
+			topo.Siblings(c.CPU, cpuid.LevelCore))
+	}
+}
+
+func printCacheDomains(offline bool, filename string) {
+	domains, err := cpuid.GetCacheDomains(offline, filename)
+	if err != nil {
+		fmt.Println("Error getting cache domains:", err)
+		return
+	}
+
+	for _, d := range domains {
+		fmt.Printf("  %s (%d KB)\n", d, d.SizeKB)
+	}
+}
+
+func printLeafProfile(iterations int, asJSON bool) {
+	p, err := cpuid.ProfileLeaves(iterations)
+	if err != nil {
+		fmt.Println("Error profiling leaves:", err)
+		os.Exit(1)
+	}
+
+	if asJSON {
+		out, err := json.MarshalIndent(p, "", "  ")
+		if err != nil {
+			fmt.Println("Error encoding profile:", err)
+			os.Exit(1)
+		}
+		fmt.Println(string(out))
+		return
+	}
+
+	fmt.Println("CPUID Leaf Latency (TSC cycles)")
+	fmt.Println("-------------------------------")
+	fmt.Printf("  CPU: %d, Iterations: %d, Timing overhead: %d, RDTSCP: %t, Hypervisor: %t\n",
+		p.CPU, p.Iterations, p.Overhead, p.RDTSCP, p.Hypervisor)
+	fmt.Printf("  %-10s %7s %8s %8s %8s  %s\n", "Leaf", "Subleaf", "Min", "Median", "P99", "VM Exit")
+	for _, l := range p.Leaves {
+		vmExit := ""
+		if l.VMExit {
+			vmExit = "yes"
+		}
+		fmt.Printf("  0x%08X %7d %8d %8d %8d  %s\n", l.Leaf, l.Subleaf, l.Min, l.Median, l.P99, vmExit)
+	}
+	fmt.Printf("  %d of %d leaves trapped\n", len(p.Trapped()), len(p.Leaves))
+}
+
+func printLatencyProfile(maxBytes uint64, asJSON bool) {
+	p, err := cpuid.ProbeLatency(maxBytes)
+	if err != nil {
+		fmt.Println("Error probing latency:", err)
+		os.Exit(1)
+	}
+
+	if asJSON {
+		out, err := json.MarshalIndent(p, "", "  ")
+		if err != nil {
+			fmt.Println("Error encoding profile:", err)
+			os.Exit(1)
+		}
+		fmt.Println(string(out))
+		return
+	}
+
+	fmt.Println("Cache and Memory Latency")
+	fmt.Println("------------------------")
+	fmt.Printf("  CPU: %d, Huge Pages: %t\n", p.CPU, p.HugePages)
+	fmt.Printf("  %12s %10s %10s\n", "Working Set", "ns", "cycles")
+	for _, pt := range p.Points {
+		fmt.Printf("  %9d KB %10.2f %10.1f\n", pt.Bytes>>10, pt.Nanos, pt.Cycles)
+	}
+	fmt.Println()
+	fmt.Printf("  %-5s %14s %14s %10s %10s  %s\n", "Level", "Reported", "Measured", "ns", "cycles", "Match")
+	for _, l := range p.Levels {
+		fmt.Printf("  L%-4d %11d KB %11d KB %10.2f %10.1f  %t\n",
+			l.Level, l.ReportedBytes>>10, l.MeasuredBytes>>10, l.Nanos, l.Cycles, l.Match)
+	}
+	if p.MemoryNanos != 0 {
+		fmt.Printf("  Memory: %.2f ns, %.1f cycles\n", p.MemoryNanos, p.MemoryCycles)
+	}
+}
+
+func printHypervisorInfo(offline bool, filename string) {
+	info := cpuid.GetHypervisorInfo(offline, filename)
+	fmt.Printf("  Hypervisor Present: %t\n", info.Present)
+	if info.Present {
+		fmt.Printf("  Hypervisor: %s\n", info.Vendor)
+		fmt.Printf("  Signature: %q\n", info.Signature)
+		fmt.Printf("  Max Hypervisor Leaf: 0x%08X\n", info.MaxLeaf)
+		if info.Interface != "" {
+			fmt.Printf("  Interface: %s\n", info.Interface)
+		}
+		fmt.Printf("  Features: %v\n", info.Features)
+		if info.TSCFrequencyKHz != 0 {
+			fmt.Printf("  TSC Frequency: %d kHz, Bus Frequency: %d kHz\n", info.TSCFrequencyKHz, info.BusFrequencyKHz)
+		}
+	}
+	fmt.Printf("  Invariant TSC: %t\n", info.InvariantTSC)
+	fmt.Printf("  Stable TSC: %t\n", info.StableTSC)
+}
+
+func printXState(offline bool, filename string) {
+	fmt.Printf("  XCR0: 0x%X\n", cpuid.GetXCR0(offline, filename))
+	supported := cpuid.GetFeatureMask(offline, filename)
+	usable := cpuid.GetUsableFeatureMask(offline, filename)
+	fmt.Printf("  Supported but not enabled by the OS: %v\n", usable.Missing(supported).Names())
+	if err := cpuid.RequestAMXPermission(); err != nil && !offline {
+		fmt.Printf("  AMX permission: %v\n", err)
+	}
+
+	layout := cpuid.GetXSaveLayout(offline, filename)
+	for _, c := range layout.Components {
+		fmt.Printf("  Component %2d: size %5d, offset %5d, aligned %t, supervisor %t, enabled %t\n",
+			c.Index, c.Size, c.Offset, c.Aligned, c.Supervisor, c.Enabled)
+	}
+	fmt.Printf("  XSAVE Area: %d bytes (max %d), compacted: %d bytes\n",
+		layout.StandardSize, layout.MaxStandardSize, layout.CompactedSize)
+}
+
+func printAMXInfo(offline bool, filename string) {
+	info := cpuid.GetAMXInfo(offline, filename)
+	fmt.Printf("  AMX Supported: %t\n", info.Supported)
+	if !info.Supported {
+		return
+	}
+	for _, p := range info.Palettes {
+		fmt.Printf("  Palette %d: %d tiles of %d rows x %d bytes (%d bytes per tile, %d bytes total)\n",
+			p.ID, p.MaxNames, p.MaxRows, p.BytesPerRow, p.BytesPerTile, p.TotalTileBytes)
+	}
+	fmt.Printf("  TMUL Max K: %d, Max N: %d bytes\n", info.TMULMaxK, info.TMULMaxN)
+	fmt.Printf("  TMUL Features: %v\n", info.Features)
+}
+
+func printTuning(offline bool, filename string) {
+	t, err := cpuid.GetTuning(offline, filename)
+	if err != nil {
+		fmt.Println("  Error:", err)
+		return
+	}
+	fmt.Printf("  Line Size:          %d bytes\n", t.LineSize)
+	fmt.Printf("  Threads Per Core:   %d\n", t.ThreadsPerCore)
+	fmt.Printf("  L1d Per Core:       %d bytes (budget %d)\n", t.L1DSize, t.L1DBudget)
+	fmt.Printf("  L2 Per Core:        %d bytes (budget %d)\n", t.L2Size, t.L2Budget)
+	fmt.Printf("  L3 Per Thread:      %d bytes (budget %d)\n", t.L3PerThread, t.L3Budget)
+	fmt.Printf("  False Sharing Pad:  %d bytes\n", t.FalseSharingPad)
+	fmt.Printf("  TLB Reach 4K Pages: %d bytes\n", t.TLBReach4K)
+	fmt.Printf("  TLB Reach 2M Pages: %d bytes\n", t.TLBReach2M)
+}
+
 func getAllFeatureCategories(compact bool) {
 	categories := cpuid.GetAllFeatureCategories()
 	for _, cat := range categories {
@@ -0,0 +1,17 @@
+// Package cpuidexpvar publishes the cpuid instrumentation counters through expvar.
+// It is a separate package so that importing cpuid does not pull in net/http.
+package cpuidexpvar
+
+import (
+	"expvar"
+
+	"github.com/earentir/cpuid"
+)
+
+// Publish exports cpuid.Stats under the given expvar name (served at /debug/vars).
+// Like expvar.Publish, it panics if the name is already in use.
+func Publish(name string) {
+	expvar.Publish(name, expvar.Func(func() interface{} {
+		return cpuid.Stats()
+	}))
+}
@@ -12,11 +12,90 @@
  */
 extern void CPUID(long leaf, long subleaf, long *eax, long *ebx, long *ecx, long *edx);
 
+/* Subleaf enumeration rules, kept in sync with subleafRules in cpuid_leaves.go. */
+#define END_NONE        0
+#define END_CACHE_TYPE  1
+#define END_LEVEL_TYPE  2
+#define END_SGX_SECTION 3
+#define END_PCONFIG     4
+
+struct subleafRule {
+    unsigned long leaf;
+    long max;       /* highest subleaf ever visited */
+    int countEax;   /* subleaf 0 EAX is the highest valid subleaf */
+    int sparse;     /* skip all-zero subleaves above 1 instead of stopping */
+    int end;        /* END_* predicate, checked above subleaf 0 */
+};
+
+static struct subleafRule subleafRules[] = {
+    { 0x4UL,        63,  0, 0, END_CACHE_TYPE },
+    { 0x7UL,        31,  1, 0, END_NONE },
+    { 0xBUL,        15,  0, 0, END_LEVEL_TYPE },
+    { 0xDUL,        63,  0, 1, END_NONE },
+    { 0xFUL,        15,  0, 1, END_NONE },
+    { 0x10UL,       15,  0, 1, END_NONE },
+    { 0x12UL,       63,  0, 0, END_SGX_SECTION },
+    { 0x14UL,       63,  1, 0, END_NONE },
+    { 0x17UL,       63,  1, 0, END_NONE },
+    { 0x18UL,       63,  1, 0, END_NONE },
+    { 0x1BUL,       63,  0, 0, END_PCONFIG },
+    { 0x1DUL,       255, 1, 0, END_NONE },
+    { 0x1EUL,       255, 1, 0, END_NONE },
+    { 0x1FUL,       15,  0, 0, END_LEVEL_TYPE },
+    { 0x20UL,       63,  1, 0, END_NONE },
+    { 0x23UL,       31,  0, 1, END_NONE },
+    { 0x24UL,       63,  1, 0, END_NONE },
+    { 0x8000001DUL, 63,  0, 0, END_CACHE_TYPE },
+    { 0x80000020UL, 15,  0, 1, END_NONE },
+    { 0x80000026UL, 15,  0, 0, END_LEVEL_TYPE }
+};
+
+#define RULE_COUNT (sizeof(subleafRules) / sizeof(subleafRules[0]))
+
+/* captureLeaf writes every subleaf of leaf described by subleafRules (only subleaf 0 otherwise). */
+static void captureLeaf(FILE *fp, unsigned long leaf) {
+    struct subleafRule *rule = 0;
+    long eax, ebx, ecx, edx;
+    long subleaf, limit = 0;
+    int i, done;
+
+    for (i = 0; i < RULE_COUNT; i++) {
+        if (subleafRules[i].leaf == leaf) {
+            rule = &subleafRules[i];
+            limit = rule->max;
+            break;
+        }
+    }
+
+    for (subleaf = 0; subleaf <= limit; subleaf++) {
+        CPUID(leaf, subleaf, &eax, &ebx, &ecx, &edx);
+        if (rule != 0) {
+            if ((subleaf == 0) && rule->countEax && ((unsigned long)eax < (unsigned long)limit))
+                limit = eax;
+            done = 0;
+            if (subleaf > 0) {
+                switch (rule->end) {
+                case END_CACHE_TYPE:  done = (eax & 0x1F) == 0; break;
+                case END_LEVEL_TYPE:  done = ((ecx >> 8) & 0xFF) == 0; break;
+                case END_SGX_SECTION: done = (subleaf >= 2) && ((eax & 0xF) == 0); break;
+                case END_PCONFIG:     done = (eax & 0xFFF) == 0; break;
+                }
+            }
+            if (done)
+                break;
+            if (rule->sparse && (subleaf > 1) && ((eax | ebx | ecx | edx) == 0))
+                continue;
+        }
+        fprintf(fp, "    { \"leaf\": %lu, \"subleaf\": %ld, \"eax\": %ld, \"ebx\": %ld, \"ecx\": %ld, \"edx\": %ld },\n",
+                leaf, subleaf, eax, ebx, ecx, edx);
+    }
+}
+
 int main(void) {
     FILE *fp;
-    unsigned long maxStandard, maxExtended;
+    unsigned long maxStandard, maxExtended, maxHypervisor;
     long eax, ebx, ecx, edx;
-    int leaf, subleaf;
+    unsigned long leaf;
 
     fp = fopen("cpuid_data.json", "w");
     if (fp == NULL) {
@@ -29,47 +108,25 @@ int main(void) {
     /* --- Capture Standard CPUID Leaves --- */
     /* CPUID(0,0) returns the maximum standard leaf in EAX */
     CPUID(0, 0, (long *)&maxStandard, &ebx, &ecx, &edx);
-    for (leaf = 0; leaf <= maxStandard; leaf++) {
-        if ((leaf == 4) || (leaf == 0xB) || (leaf == 0xD)) {
-            subleaf = 0;
-            while (1) {
-                CPUID(leaf, subleaf, &eax, &ebx, &ecx, &edx);
-                if ((leaf == 4) && (subleaf > 0) && ((eax & 0x1F) == 0))
-                    break;
-                if ((leaf == 0xB) && (subleaf > 0) && (eax == 0))
-                    break;
-                if ((leaf == 0xD) && (subleaf > 0) && (eax == 0) && (ebx == 0) && (ecx == 0) && (edx == 0))
-                    break;
-                fprintf(fp, "    { \"leaf\": %d, \"subleaf\": %d, \"eax\": %ld, \"ebx\": %ld, \"ecx\": %ld, \"edx\": %ld },\n",
-                        leaf, subleaf, eax, ebx, ecx, edx);
-                subleaf++;
-            }
-        } else {
-            CPUID(leaf, 0, &eax, &ebx, &ecx, &edx);
-            fprintf(fp, "    { \"leaf\": %d, \"subleaf\": 0, \"eax\": %ld, \"ebx\": %ld, \"ecx\": %ld, \"edx\": %ld },\n",
-                    leaf, eax, ebx, ecx, edx);
-        }
+    for (leaf = 0; leaf <= maxStandard; leaf++)
+        captureLeaf(fp, leaf);
+
+    /* --- Capture Hypervisor CPUID Leaves (only under a hypervisor, CPUID.1:ECX[31]) --- */
+    CPUID(1, 0, &eax, &ebx, &ecx, &edx);
+    if ((maxStandard >= 1) && (ecx & 0x80000000L)) {
+        CPUID(0x40000000, 0, (long *)&maxHypervisor, &ebx, &ecx, &edx);
+        if (maxHypervisor < 0x40000000UL)
+            maxHypervisor = 0x40000001UL; /* older KVM reports 0 */
+        if (maxHypervisor > 0x400000FFUL)
+            maxHypervisor = 0x400000FFUL;
+        for (leaf = 0x40000000UL; leaf <= maxHypervisor; leaf++)
+            captureLeaf(fp, leaf);
     }
 
     /* --- Capture Extended CPUID Leaves --- */
     CPUID(0x80000000, 0, (long *)&maxExtended, &ebx, &ecx, &edx);
-    for (leaf = 0x80000000; leaf <= maxExtended; leaf++) {
-        if (leaf == 0x8000001D) {
-            subleaf = 0;
-            while (1) {
-                CPUID(leaf, subleaf, &eax, &ebx, &ecx, &edx);
-                if ((subleaf > 0) && ((eax & 0x1F) == 0))
-                    break;
-                fprintf(fp, "    { \"leaf\": %d, \"subleaf\": %d, \"eax\": %ld, \"ebx\": %ld, \"ecx\": %ld, \"edx\": %ld },\n",
-                        leaf, subleaf, eax, ebx, ecx, edx);
-                subleaf++;
-            }
-        } else {
-            CPUID(leaf, 0, &eax, &ebx, &ecx, &edx);
-            fprintf(fp, "    { \"leaf\": %d, \"subleaf\": 0, \"eax\": %ld, \"ebx\": %ld, \"ecx\": %ld, \"edx\": %ld },\n",
-                    leaf, eax, ebx, ecx, edx);
-        }
-    }
+    for (leaf = 0x80000000UL; leaf <= maxExtended; leaf++)
+        captureLeaf(fp, leaf);
 
     /* Finalize JSON (the last trailing comma can be cleaned up manually if needed) */
     fprintf(fp, "  ]\n}\n");
@@ -18,6 +18,49 @@ type
 var
   F: Text;
 
+{ Subleaf enumeration rules, kept in sync with subleafRules in cpuid_leaves.go.
+  Max is the highest subleaf ever visited; with CountEAX subleaf 0 EAX lowers it; Sparse skips
+  all-zero subleaves above 1 instead of stopping; EndKind ends the walk above subleaf 0. }
+const
+  EndNone = 0;
+  EndCacheType = 1;
+  EndLevelType = 2;
+  EndSGXSection = 3;
+  EndPCONFIG = 4;
+
+type
+  TSubleafRule = record
+    Leaf: LongInt;
+    Max: LongInt;
+    CountEAX: Boolean;
+    Sparse: Boolean;
+    EndKind: Integer;
+  end;
+
+const
+  SubleafRules: array[0..19] of TSubleafRule = (
+    (Leaf: $4; Max: 63; CountEAX: False; Sparse: False; EndKind: EndCacheType),
+    (Leaf: $7; Max: 31; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $B; Max: 15; CountEAX: False; Sparse: False; EndKind: EndLevelType),
+    (Leaf: $D; Max: 63; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $F; Max: 15; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $10; Max: 15; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $12; Max: 63; CountEAX: False; Sparse: False; EndKind: EndSGXSection),
+    (Leaf: $14; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $17; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $18; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $1B; Max: 63; CountEAX: False; Sparse: False; EndKind: EndPCONFIG),
+    (Leaf: $1D; Max: 255; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $1E; Max: 255; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $1F; Max: 15; CountEAX: False; Sparse: False; EndKind: EndLevelType),
+    (Leaf: $20; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $23; Max: 31; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $24; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $8000001D; Max: 63; CountEAX: False; Sparse: False; EndKind: EndCacheType),
+    (Leaf: $80000020; Max: 15; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $80000026; Max: 15; CountEAX: False; Sparse: False; EndKind: EndLevelType)
+  );
+
 {--------------------------------------------------------------------
   CPUID is declared as an external procedure. It takes two 32‑bit input
   parameters (Leaf and SubLeaf) and four var parameters (to receive the
@@ -39,9 +82,57 @@ begin
     Writeln(F);
 end;
 
+{--------------------------------------------------------------------
+  CaptureLeaf writes every subleaf of Leaf described by SubleafRules
+  (only subleaf 0 for leaves without a rule).
+--------------------------------------------------------------------}
+procedure CaptureLeaf(Leaf: LongInt);
 var
-  maxStandard, maxExtended: LongInt;
-  leaf, subleaf: LongInt;
+  i: Integer;
+  HasRule, Done, Skip: Boolean;
+  Rule: TSubleafRule;
+  subleaf, limit: LongInt;
+  a, b, c, d: LongInt;
+begin
+  HasRule := False;
+  limit := 0;
+  for i := Low(SubleafRules) to High(SubleafRules) do
+    if (not HasRule) and (SubleafRules[i].Leaf = Leaf) then
+    begin
+      Rule := SubleafRules[i];
+      HasRule := True;
+      limit := Rule.Max;
+    end;
+
+  subleaf := 0;
+  Done := False;
+  while (subleaf <= limit) and not Done do
+  begin
+    CPUID(Leaf, subleaf, a, b, c, d);
+    Skip := False;
+    if HasRule then
+    begin
+      { EAX is compared unsigned: a negative LongInt is above any bound }
+      if (subleaf = 0) and Rule.CountEAX and (a >= 0) and (a < limit) then
+        limit := a;
+      if subleaf > 0 then
+        case Rule.EndKind of
+          EndCacheType:  Done := (a and $1F) = 0;
+          EndLevelType:  Done := ((c shr 8) and $FF) = 0;
+          EndSGXSection: Done := (subleaf >= 2) and ((a and $F) = 0);
+          EndPCONFIG:    Done := (a and $FFF) = 0;
+        end;
+      Skip := Rule.Sparse and (subleaf > 1) and ((a or b or c or d) = 0);
+    end;
+    if not Done and not Skip then
+      WriteEntry(Leaf, subleaf, a, b, c, d, False);
+    Inc(subleaf);
+  end;
+end;
+
+var
+  maxStandard, maxExtended, maxHypervisor: LongInt;
+  leaf: LongInt;
   a, b, c, d: LongInt;
 begin
   ClrScr;
@@ -54,51 +145,23 @@ begin
   { Call CPUID(0,0) which returns the maximum standard leaf in EAX. }
   CPUID(0, 0, maxStandard, b, c, d);
   for leaf := 0 to maxStandard do
+    CaptureLeaf(leaf);
+
+  { --- Capture Hypervisor CPUID Leaves (only under a hypervisor, CPUID.1:ECX[31]) --- }
+  CPUID(1, 0, a, b, c, d);
+  if (maxStandard >= 1) and (c < 0) then  { bit 31 is the sign bit of a LongInt }
   begin
-    if (leaf = 4) or (leaf = $B) or (leaf = $D) then
-    begin
-      subleaf := 0;
-      while True do
-      begin
-        CPUID(leaf, subleaf, a, b, c, d);
-        { For leaf 4: if subleaf > 0 and the lower 5 bits of EAX are zero, break. }
-        if (leaf = 4) and (subleaf > 0) and ((a and $1F) = 0) then Break;
-        { For leaf $B: if subleaf > 0 and EAX is zero, break. }
-        if (leaf = $B) and (subleaf > 0) and (a = 0) then Break;
-        { For leaf $D: if subleaf > 0 and all registers are zero, break. }
-        if (leaf = $D) and (subleaf > 0) and (a = 0) and (b = 0) and (c = 0) and (d = 0) then Break;
-        WriteEntry(leaf, subleaf, a, b, c, d, False);
-        Inc(subleaf);
-      end;
-    end
-    else
-    begin
-      CPUID(leaf, 0, a, b, c, d);
-      WriteEntry(leaf, 0, a, b, c, d, False);
-    end;
+    CPUID($40000000, 0, maxHypervisor, b, c, d);
+    if maxHypervisor < $40000000 then maxHypervisor := $40000001;  { older KVM reports 0 }
+    if maxHypervisor > $400000FF then maxHypervisor := $400000FF;
+    for leaf := $40000000 to maxHypervisor do
+      CaptureLeaf(leaf);
   end;
 
   { --- Capture Extended CPUID Leaves --- }
   CPUID($80000000, 0, maxExtended, b, c, d);
   for leaf := $80000000 to maxExtended do
-  begin
-    if leaf = $8000001D then
-    begin
-      subleaf := 0;
-      while True do
-      begin
-        CPUID(leaf, subleaf, a, b, c, d);
-        if (subleaf > 0) and ((a and $1F) = 0) then Break;
-        WriteEntry(leaf, subleaf, a, b, c, d, False);
-        Inc(subleaf);
-      end;
-    end
-    else
-    begin
-      CPUID(leaf, 0, a, b, c, d);
-      WriteEntry(leaf, 0, a, b, c, d, False);
-    end;
-  end;
+    CaptureLeaf(leaf);
 
   { --- Finalize JSON --- }
   Writeln(F, '  ]');
@@ -14,11 +14,64 @@ typedef struct {
 
 #define INITIAL_ENTRIES 64
 
+/* Subleaf enumeration rules, kept in sync with subleafRules in cpuid_leaves.go. */
+enum { END_NONE, END_CACHE_TYPE, END_LEVEL_TYPE, END_SGX_SECTION, END_PCONFIG };
+
+typedef struct {
+    uint32_t leaf;
+    uint32_t max;      /* highest subleaf ever visited */
+    int countEax;      /* subleaf 0 EAX is the highest valid subleaf */
+    int sparse;        /* skip all-zero subleaves above 1 instead of stopping */
+    int end;           /* END_* predicate, checked above subleaf 0 */
+} SubleafRule;
+
+static const SubleafRule subleafRules[] = {
+    { 0x4,        63,  0, 0, END_CACHE_TYPE },
+    { 0x7,        31,  1, 0, END_NONE },
+    { 0xB,        15,  0, 0, END_LEVEL_TYPE },
+    { 0xD,        63,  0, 1, END_NONE },
+    { 0xF,        15,  0, 1, END_NONE },
+    { 0x10,       15,  0, 1, END_NONE },
+    { 0x12,       63,  0, 0, END_SGX_SECTION },
+    { 0x14,       63,  1, 0, END_NONE },
+    { 0x17,       63,  1, 0, END_NONE },
+    { 0x18,       63,  1, 0, END_NONE },
+    { 0x1B,       63,  0, 0, END_PCONFIG },
+    { 0x1D,       255, 1, 0, END_NONE },
+    { 0x1E,       255, 1, 0, END_NONE },
+    { 0x1F,       15,  0, 0, END_LEVEL_TYPE },
+    { 0x20,       63,  1, 0, END_NONE },
+    { 0x23,       31,  0, 1, END_NONE },
+    { 0x24,       63,  1, 0, END_NONE },
+    { 0x8000001D, 63,  0, 0, END_CACHE_TYPE },
+    { 0x80000020, 15,  0, 1, END_NONE },
+    { 0x80000026, 15,  0, 0, END_LEVEL_TYPE },
+};
+
+static const SubleafRule *findRule(uint32_t leaf) {
+    size_t i;
+    for (i = 0; i < sizeof(subleafRules) / sizeof(subleafRules[0]); i++) {
+        if (subleafRules[i].leaf == leaf)
+            return &subleafRules[i];
+    }
+    return NULL;
+}
+
+static int ruleEnds(const SubleafRule *r, uint32_t subleaf, uint32_t eax, uint32_t ecx) {
+    switch (r->end) {
+    case END_CACHE_TYPE:  return (eax & 0x1F) == 0;
+    case END_LEVEL_TYPE:  return ((ecx >> 8) & 0xFF) == 0;
+    case END_SGX_SECTION: return subleaf >= 2 && (eax & 0xF) == 0;
+    case END_PCONFIG:     return (eax & 0xFFF) == 0;
+    default:              return 0;
+    }
+}
+
 int main(void) {
     CPUIDEntry *entries = NULL;
     size_t count = 0, capacity = INITIAL_ENTRIES;
     FILE *fp;
-    uint32_t maxStandard, maxExtended;
+    uint32_t maxStandard, maxExtended, maxHypervisor;
     uint32_t eax, ebx, ecx, edx;
     uint32_t leaf, subleaf;
 
@@ -46,49 +99,50 @@ int main(void) {
         count++;                                          \
     } while(0)
 
+    /* Capture every subleaf of a leaf as described by subleafRules. __cpuid_count() is used
+       directly because __get_cpuid_count() refuses leaves outside the standard range. */
+    #define CAPTURE_LEAF(LF) do {                                           \
+        const SubleafRule *rule = findRule(LF);                             \
+        uint32_t limit = rule ? rule->max : 0;                              \
+        for (subleaf = 0; subleaf <= limit; subleaf++) {                    \
+            __cpuid_count((LF), subleaf, eax, ebx, ecx, edx);               \
+            if (rule && subleaf == 0 && rule->countEax && eax < limit)      \
+                limit = eax;                                                \
+            if (rule && subleaf > 0 && ruleEnds(rule, subleaf, eax, ecx))   \
+                break;                                                      \
+            if (rule && rule->sparse && subleaf > 1 &&                      \
+                (eax | ebx | ecx | edx) == 0)                               \
+                continue;                                                   \
+            APPEND_ENTRY((LF), subleaf, eax, ebx, ecx, edx);                \
+        }                                                                   \
+    } while(0)
+
     /* --- Capture Standard CPUID Leaves --- */
     if (!__get_cpuid(0, &maxStandard, &ebx, &ecx, &edx)) {
         fprintf(stderr, "CPUID not supported.\n");
         free(entries);
         return 1;
     }
-    for (leaf = 0; leaf <= maxStandard; leaf++) {
-        if (leaf == 4 || leaf == 0xB || leaf == 0xD) {
-            subleaf = 0;
-            while (1) {
-                __get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx);
-                if (leaf == 4 && subleaf > 0 && ((eax & 0x1F) == 0))
-                    break;
-                if (leaf == 0xB && subleaf > 0 && (eax == 0))
-                    break;
-                if (leaf == 0xD && subleaf > 0 && (eax==0 && ebx==0 && ecx==0 && edx==0))
-                    break;
-                APPEND_ENTRY(leaf, subleaf, eax, ebx, ecx, edx);
-                subleaf++;
-            }
-        } else {
-            __get_cpuid(leaf, &eax, &ebx, &ecx, &edx);
-            APPEND_ENTRY(leaf, 0, eax, ebx, ecx, edx);
-        }
+    for (leaf = 0; leaf <= maxStandard; leaf++)
+        CAPTURE_LEAF(leaf);
+
+    /* --- Capture Hypervisor CPUID Leaves (only under a hypervisor, CPUID.1:ECX[31]) --- */
+    /* __get_cpuid() refuses leaves above the standard maximum, so use __cpuid() directly. */
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (maxStandard >= 1 && (ecx & 0x80000000)) {
+        __cpuid(0x40000000, maxHypervisor, ebx, ecx, edx);
+        if (maxHypervisor < 0x40000000)
+            maxHypervisor = 0x40000001; /* older KVM reports 0 */
+        if (maxHypervisor > 0x400000FF)
+            maxHypervisor = 0x400000FF;
+        for (leaf = 0x40000000; leaf <= maxHypervisor; leaf++)
+            CAPTURE_LEAF(leaf);
     }
 
     /* --- Capture Extended CPUID Leaves --- */
     __get_cpuid(0x80000000, &maxExtended, &ebx, &ecx, &edx);
-    for (leaf = 0x80000000; leaf <= maxExtended; leaf++) {
-        if (leaf == 0x8000001D) {
-            subleaf = 0;
-            while (1) {
-                __get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx);
-                if (subleaf > 0 && ((eax & 0x1F) == 0))
-                    break;
-                APPEND_ENTRY(leaf, subleaf, eax, ebx, ecx, edx);
-                subleaf++;
-            }
-        } else {
-            __get_cpuid(leaf, &eax, &ebx, &ecx, &edx);
-            APPEND_ENTRY(leaf, 0, eax, ebx, ecx, edx);
-        }
-    }
+    for (leaf = 0x80000000; leaf <= maxExtended; leaf++)
+        CAPTURE_LEAF(leaf);
 
     /* --- Write JSON Output --- */
     fp = fopen("cpuid_data.json", "w");
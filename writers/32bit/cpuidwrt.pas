@@ -22,6 +22,49 @@ type
 var
   Entries: array of TEntry;
 
+{ Subleaf enumeration rules, kept in sync with subleafRules in cpuid_leaves.go.
+  Max is the highest subleaf ever visited; with CountEAX subleaf 0 EAX lowers it; Sparse skips
+  all-zero subleaves above 1 instead of stopping; EndKind ends the walk above subleaf 0. }
+const
+  EndNone = 0;
+  EndCacheType = 1;
+  EndLevelType = 2;
+  EndSGXSection = 3;
+  EndPCONFIG = 4;
+
+type
+  TSubleafRule = record
+    Leaf: LongWord;
+    Max: LongWord;
+    CountEAX: Boolean;
+    Sparse: Boolean;
+    EndKind: Integer;
+  end;
+
+const
+  SubleafRules: array[0..19] of TSubleafRule = (
+    (Leaf: $4; Max: 63; CountEAX: False; Sparse: False; EndKind: EndCacheType),
+    (Leaf: $7; Max: 31; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $B; Max: 15; CountEAX: False; Sparse: False; EndKind: EndLevelType),
+    (Leaf: $D; Max: 63; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $F; Max: 15; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $10; Max: 15; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $12; Max: 63; CountEAX: False; Sparse: False; EndKind: EndSGXSection),
+    (Leaf: $14; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $17; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $18; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $1B; Max: 63; CountEAX: False; Sparse: False; EndKind: EndPCONFIG),
+    (Leaf: $1D; Max: 255; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $1E; Max: 255; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $1F; Max: 15; CountEAX: False; Sparse: False; EndKind: EndLevelType),
+    (Leaf: $20; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $23; Max: 31; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $24; Max: 63; CountEAX: True; Sparse: False; EndKind: EndNone),
+    (Leaf: $8000001D; Max: 63; CountEAX: False; Sparse: False; EndKind: EndCacheType),
+    (Leaf: $80000020; Max: 15; CountEAX: False; Sparse: True; EndKind: EndNone),
+    (Leaf: $80000026; Max: 15; CountEAX: False; Sparse: False; EndKind: EndLevelType)
+  );
+
 {------------------------------------------------------------
   cpuid executes the CPUID instruction.
   Parameters:
@@ -59,59 +102,82 @@ begin
   end;
 end;
 
-procedure CaptureData;
+{ CaptureLeaf appends every subleaf of Leaf described by SubleafRules (only subleaf 0 otherwise). }
+procedure CaptureLeaf(Leaf: LongWord);
 var
-  leaf, subleaf: LongWord;
-  maxStandard, maxExtended: LongWord;
+  i: Integer;
+  HasRule, Done: Boolean;
+  Rule: TSubleafRule;
+  subleaf, limit: LongWord;
   a, b, c, d: LongWord;
 begin
-  SetLength(Entries, 0);
+  HasRule := False;
+  limit := 0;
+  for i := Low(SubleafRules) to High(SubleafRules) do
+    if SubleafRules[i].Leaf = Leaf then
+    begin
+      Rule := SubleafRules[i];
+      HasRule := True;
+      limit := Rule.Max;
+      Break;
+    end;
 
-  {--- Capture Standard CPUID Leaves ---}
-  cpuid(0, 0, maxStandard, b, c, d);  { maxStandard is in EAX }
-  for leaf := 0 to maxStandard do
+  subleaf := 0;
+  while subleaf <= limit do
   begin
-    if (leaf = 4) or (leaf = $B) or (leaf = $D) then
+    cpuid(Leaf, subleaf, a, b, c, d);
+    if HasRule then
     begin
-      subleaf := 0;
-      while True do
+      if (subleaf = 0) and Rule.CountEAX and (a < limit) then
+        limit := a;
+      Done := False;
+      if subleaf > 0 then
+        case Rule.EndKind of
+          EndCacheType:  Done := (a and $1F) = 0;
+          EndLevelType:  Done := ((c shr 8) and $FF) = 0;
+          EndSGXSection: Done := (subleaf >= 2) and ((a and $F) = 0);
+          EndPCONFIG:    Done := (a and $FFF) = 0;
+        end;
+      if Done then Break;
+      if Rule.Sparse and (subleaf > 1) and ((a or b or c or d) = 0) then
       begin
-        cpuid(leaf, subleaf, a, b, c, d);
-        if (leaf = 4) and (subleaf > 0) and ((a and $1F) = 0) then Break;
-        if (leaf = $B) and (subleaf > 0) and (a = 0) then Break;
-        if (leaf = $D) and (subleaf > 0) and (a = 0) and (b = 0) and (c = 0) and (d = 0) then Break;
-        AppendEntry(leaf, subleaf, a, b, c, d);
         Inc(subleaf);
+        Continue;
       end;
-    end
-    else
-    begin
-      cpuid(leaf, 0, a, b, c, d);
-      AppendEntry(leaf, 0, a, b, c, d);
     end;
+    AppendEntry(Leaf, subleaf, a, b, c, d);
+    Inc(subleaf);
+  end;
+end;
+
+procedure CaptureData;
+var
+  leaf: LongWord;
+  maxStandard, maxExtended, maxHypervisor: LongWord;
+  a, b, c, d: LongWord;
+begin
+  SetLength(Entries, 0);
+
+  {--- Capture Standard CPUID Leaves ---}
+  cpuid(0, 0, maxStandard, b, c, d);  { maxStandard is in EAX }
+  for leaf := 0 to maxStandard do
+    CaptureLeaf(leaf);
+
+  {--- Capture Hypervisor CPUID Leaves (only under a hypervisor, CPUID.1:ECX[31]) ---}
+  cpuid(1, 0, a, b, c, d);
+  if (maxStandard >= 1) and ((c and $80000000) <> 0) then
+  begin
+    cpuid($40000000, 0, maxHypervisor, b, c, d);
+    if maxHypervisor < $40000000 then maxHypervisor := $40000001;  { older KVM reports 0 }
+    if maxHypervisor > $400000FF then maxHypervisor := $400000FF;
+    for leaf := $40000000 to maxHypervisor do
+      CaptureLeaf(leaf);
   end;
 
   {--- Capture Extended CPUID Leaves ---}
   cpuid($80000000, 0, maxExtended, b, c, d);  { maxExtended in EAX }
   for leaf := $80000000 to maxExtended do
-  begin
-    if (leaf = $8000001D) then
-    begin
-      subleaf := 0;
-      while True do
-      begin
-        cpuid(leaf, subleaf, a, b, c, d);
-        if (subleaf > 0) and ((a and $1F) = 0) then Break;
-        AppendEntry(leaf, subleaf, a, b, c, d);
-        Inc(subleaf);
-      end;
-    end
-    else
-    begin
-      cpuid(leaf, 0, a, b, c, d);
-      AppendEntry(leaf, 0, a, b, c, d);
-    end;
-  end;
+    CaptureLeaf(leaf);
 end;
 
 procedure WriteJSON(const AFileName: string);